@@ -1,19 +1,25 @@
+#include "mrtos_config.h"
+
   EXTERN runPtr
   EXTERN firstSwitch
   EXTERN OS_Schedule
+  EXTERN OS_ProfilerSysTick
   
   PUBLIC PendSV_Handler
   PUBLIC OS_CriticalEnter
   PUBLIC OS_CriticalExit
   PUBLIC OS_DisableInterrupts
   PUBLIC OS_EnableInterrupt
+  PUBLIC OS_ProfilerSysTickEntry
   
   SECTION .text:CODE:NOROOT(3)
   THUMB
 
 ; Does the context switch for the OS, scheduling (updating value of runPt) is done by OS_Schedule (C-code)
 PendSV_Handler
-    CPSID I            ; Disable interrupts
+    MOV R3,#MAX_SYSCALL_INTERRUPT_PRIORITY
+    MSR BASEPRI,R3     ; Mask interrupts that can call the kernel, higher priority ones keep running
+    ISB
     MOV R1,#0x1
     LDR R0,=firstSwitch
     LDR R2,[R0]
@@ -32,23 +38,42 @@ Schedule
     LDR R1,[R0]        ; R0 points to runPt, which points to a TCB, that was updated by the OS_Schedule function
     LDR SP,[R1]        ; Load the stack pointer of the current thread to the SP register
     POP {R4-R11}       ; Pop the R4-R11 registers which were pushed when the thread was previously switched from
-    CPSIE I            ; Enable interrupts
+    MOV R3,#0
+    MSR BASEPRI,R3     ; Unmask interrupts
     BX LR              ; Return from handler
 
+; Critical sections mask with BASEPRI instead of PRIMASK, interrupts above MAX_SYSCALL_INTERRUPT_PRIORITY never wait
+; for the kernel. PRIMASK is only used by OS_DisableInterrupts during startup.
 OS_CriticalEnter
-    MRS R0, PRIMASK     ;Save old interrupt mask priority to R0 (Return register)
-    CPSID I             ;Disable interrupts
+    MRS R0, BASEPRI     ;Save old interrupt mask priority to R0 (Return register)
+    MOV R1,#MAX_SYSCALL_INTERRUPT_PRIORITY
+    MSR BASEPRI_MAX, R1 ;Mask interrupts at and below the syscall priority, never lowers an already higher mask
+    ISB                 ;Make sure the mask is in effect before the first instruction of the section
     BX LR
 
 OS_CriticalExit
-    MSR PRIMASK, R0     ;Load old interrupt mask priority from R0 (1st param register)
-    CPSIE I             ;Enable interrupts
+    MSR BASEPRI, R0     ;Restore old interrupt mask from R0 (1st param register), nested sections stay masked
     BX LR
 
 OS_DisableInterrupts
     CPSID I
+    BX LR
 
 OS_EnableInterrupt
     CPSIE I
+    BX LR
+
+; Own section so that the linker drops it (and the reference to OS_ProfilerSysTick) when the profiler is not used
+  SECTION .text:CODE:NOROOT(2)
+  THUMB
+
+; SysTick vector when PROFILER_ENABLED, passes the PC the interrupt was taken at to the profiler
+OS_ProfilerSysTickEntry
+    TST LR,#0x4        ; EXC_RETURN bit 2 tells which stack the exception frame was pushed to
+    ITE EQ
+    MRSEQ R0,MSP
+    MRSNE R0,PSP
+    LDR R0,[R0,#24]    ; Stacked PC is the 7th word of the exception frame
+    B OS_ProfilerSysTick ; Tail call, LR still holds EXC_RETURN for the return from the handler
 
   END
\ No newline at end of file
@@ -5,7 +5,9 @@
 #ifndef MRTOS_MRTOS_CONFIG_H
 #define MRTOS_MRTOS_CONFIG_H
 
+#ifndef __IAR_SYSTEMS_ASM__
 #include "stdint.h"
+#endif
 
 //TODO: create double for tests or use another approach for the configuration
 
@@ -14,16 +16,59 @@
 #define THREAD_MAX_PRIORITY 0           // any x >= 0
 #define NUM_USER_THREADS 10
 #define THREAD_TIME_SLICE_MILLIS 5
+#define STACK_PAINT_PATTERN 0xCDCDCDCD  // Unused stack is filled with this, the lowest element doubles as a canary
+#define STACK_CHECK_ENABLED 1           // Check the canary of the outgoing thread at every context switch
+#define THREAD_STATS_ENABLED 1          // Account run time and context switches of every thread using BSP_GetTimestamp
+#define THREAD_BUDGET_ENABLED 0         // Throttle threads that use more CPU time per window than OS_SetThreadBudget allows
+#define DEFER_QUEUE_LENGTH 16           // Power of two, deferred calls that can be queued for the worker thread at once
+#define DEFER_WORKER_PRIORITY 1         // Priority of the thread running the deferred calls
+#define DEFER_WORKER_STACK_SIZE 256     // Stack of the worker in elements, shared by every deferred call
+#define TIMER_DAEMON_PRIORITY 1         // Priority of the thread running the software timer callbacks
+#define TIMER_DAEMON_STACK_SIZE 256     // Stack of the daemon in elements, shared by every timer callback
+#define TABLE_THREAD_PRIORITY 0         // Priority of the threads released by the schedule table, keep it above the rest
+/* ---------------------- Debug configuration ----------------------------*/
+#define TRACE_ENABLED 0                 // Record kernel events to a RAM ring, compiled out completely when 0
+#define TRACE_BUFFER_RECORDS 256        // Power of two, each record takes 12 bytes
+#define PROFILER_ENABLED 0              // Sample the interrupted PC on SysTick, needs OS_ProfilerSysTickEntry as the vector
+#define PROFILER_BUCKETS 128            // Power of two, distinct (PC, thread) pairs the histogram can hold
+#define CRITICAL_PROFILING_ENABLED 0    // Time every kernel critical section and keep statistics per call site
+#define CRITICAL_PROFILING_SITES 64     // Call sites the statistics table can hold
+#define CRITICAL_HISTOGRAM_BUCKETS 16   // Log2 buckets of the duration in BSP_GetTimestamp ticks
+#define WAKEUP_LATENCY_ENABLED 0        // Measure the time from a thread becoming ready to it being dispatched
+#define WAKEUP_HISTOGRAM_BUCKETS 16     // Log2 buckets of the latency in BSP_GetTimestamp ticks
+/* ---------------------- Interrupt configuration ------------------------*/
+#define MAX_SYSCALL_INTERRUPT_PRIORITY 0x50 // BASEPRI of kernel critical sections (already shifted, never 0), interrupts
+                                            // of numerically lower priority are never masked and must not call the kernel
+#define SYSCALL_PRIORITY_CHECK_ENABLED 1    // Assert that ISR callable kernel functions are not called above the threshold
 /* ---------------------- System configuration ---------------------------*/
 #define SYSCLOCK_FREQUENCY 80
 #define SYS_TICK_PERIOD_MILLIS 1
+/* ---------------------- Memory configuration ---------------------------*/
+#define DOUBLE_BUFFER_ALIGNMENT 32      // DMA buffers are aligned and padded to this, use the cache line size if any
+#define HEAP_SL_INDEX_COUNT_LOG2 4      // TLSF heap splits every power of two size class into 2^x free lists
+#define HEAP_FL_INDEX_MAX 24            // TLSF heap blocks can be at most 2^x bytes
 
 #ifdef TEST
 #define NUM_USER_THREADS 10
+#undef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#undef TRACE_BUFFER_RECORDS
+#define TRACE_BUFFER_RECORDS 8
+#undef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#undef PROFILER_BUCKETS
+#define PROFILER_BUCKETS 4
+#undef WAKEUP_LATENCY_ENABLED
+#define WAKEUP_LATENCY_ENABLED 1
+#undef THREAD_BUDGET_ENABLED
+#define THREAD_BUDGET_ENABLED 1
 #endif
 
 
 /* --------------------- Configuration typedefs ----------------------------*/
+// The assembly port includes this file for the interrupt configuration, so the typedefs are hidden from it
+#ifndef __IAR_SYSTEMS_ASM__
 typedef uint32_t StackElementTypeDef;       // 32-bit wide stack
+#endif
 
 #endif //MRTOS_MRTOS_CONFIG_H
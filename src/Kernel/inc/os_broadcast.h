@@ -0,0 +1,67 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_BROADCAST_H
+#define SIMPLERTOS_OS_BROADCAST_H
+
+#include "stdint.h"
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * A broadcast channel is a ring buffer with a single writer and any number of readers. Reading does not consume
+ * the data, every reader has its own cursor into the ring, so publishing to N readers costs a single write.
+ * The writer never blocks: if a reader falls behind by more than the capacity of the ring, the oldest data is
+ * overwritten and only that reader's missed counter is incremented.
+ */
+typedef struct {
+    uint32_t elements;
+    uint32_t dataSizeBytes;
+    uint32_t writeCount;        // Total amount of elements ever written, readers compare their cursor against this
+    uint32_t writeIndex;
+    void *dataPtr;
+} OS_BroadcastTypeDef;
+
+typedef struct {
+    OS_BroadcastTypeDef *channel;
+    uint32_t readCount;         // Value of the channels writeCount that the next read will start from
+    uint32_t missed;
+    uint32_t lastReadSize;
+} OS_BroadcastReaderTypeDef;
+
+
+/* ------------------------------------------ Broadcast channel functions ------------------------------------------ */
+/**
+ * @brief: Initializes a broadcast channel
+ * @param channel: The channel to initialize
+ * @param dataPtr: Pointer to the pre-allocated storage, must fit elements*dataSizeBytes bytes
+ * @param elements: How many elements the storage has been allocated for
+ * @param dataSizeBytes: Size of a single element in bytes
+ */
+void OS_BroadcastInit(OS_BroadcastTypeDef *channel, void *dataPtr, uint32_t elements, uint32_t dataSizeBytes);
+
+/**
+ * @brief: Attaches a reader to a channel. The reader will only see data written after subscribing.
+ * @param channel: The channel to subscribe to
+ * @param reader: The reader to initialize
+ */
+void OS_BroadcastSubscribe(OS_BroadcastTypeDef *channel, OS_BroadcastReaderTypeDef *reader);
+
+/**
+ * @brief: Publishes elements to every reader of the channel. Never blocks, overwrites the oldest data if needed.
+ * @param channel: The channel to write to
+ * @param dataPtr: Pointer to the elements to write
+ * @param dataSize: Amount of elements to write
+ */
+void OS_BroadcastWrite(OS_BroadcastTypeDef *channel, void *dataPtr, uint32_t dataSize);
+
+/**
+ * @brief: Reads up to dataSize of the oldest elements the reader has not seen yet. Does not block, the amount of
+ *         elements actually read is stored in reader->lastReadSize.
+ * @param reader: The reader whose cursor is used and advanced
+ * @param dataPtr: Pointer to the destination storage
+ * @param dataSize: Maximum amount of elements to read
+ */
+void OS_BroadcastRead(OS_BroadcastReaderTypeDef *reader, void *dataPtr, uint32_t dataSize);
+
+#endif //SIMPLERTOS_OS_BROADCAST_H
@@ -24,4 +24,10 @@ void OS_BufferInit(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t eleme
 void OS_BufferRead(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t dataSize);
 void OS_BufferWrite(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t dataSize);
 
+/**
+ * @brief: Writes to the buffer from an ISR. Never blocks, overwrites the oldest data if the buffer is full. If a
+ *         higher priority thread is woken the reschedule is deferred to OS_YieldFromISR.
+ */
+void OS_BufferWriteFromISR(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t dataSize);
+
 #endif //SIMPLERTOS_OS_BUFFERS_H
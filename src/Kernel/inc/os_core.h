@@ -14,34 +14,79 @@ typedef enum {
     READY,
     BLOCKED,
     ASLEEP,
+    DORMANT,    // Exists but is in none of the thread lists, e.g. a periodic thread waiting for its next release
     INACTIVE
 } OS_StateTypeDef;
 // Forward definition as OS_SemaphoreObjectTypeDef depends on OS_TCBTypeDef, and vice versa
 typedef struct OS_SemaphoreStruct OS_SemaphoreObjectTypeDef;
+typedef struct OS_SelectObjectStruct OS_SelectObjectTypeDef;
+typedef struct OS_PoolStruct OS_PoolTypeDef;
+typedef struct OS_ServerStruct OS_ServerTypeDef;
+
+#define OS_WAIT_FOREVER 0xFFFFFFFF
+#define OS_IDLE_THREAD_ID 0xFF
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t histogram[WAKEUP_HISTOGRAM_BUCKETS];  // Bucket n counts latencies of [2^(n-1), 2^n) ticks
+} OS_LatencyStatsTypeDef;
 
 typedef struct OS_TCBStruct OS_TCBTypeDef;
 struct OS_TCBStruct {
     StackElementTypeDef *stkPtr;
+    StackElementTypeDef *stackBase;             // Lowest address of the stack memory
+    OS_PoolTypeDef *stackPool;                  // Pool the stack was allocated from, NULL if provided by the user
     OS_TCBTypeDef *next;
     OS_TCBTypeDef *prev;
     const char *identifier;
     uint8_t id;
+    uint32_t generation;                        // Incremented every time the TCB is freed, tells stale handles apart
     uint32_t stackSize;
     uint32_t basePriority;
     uint32_t priority;
     OS_SemaphoreObjectTypeDef *blockPtr;
-    uint32_t sleep;
-    uint32_t basePeriod;
-    uint32_t period;
+    OS_SemaphoreObjectTypeDef *ownedMutexes;    // Linked through the semaphores, released if the thread is deleted
+    uint32_t sleep;                             // Requested sleep or timeout in milliseconds, 0 if not sleeping
+    uint64_t wakeTick;                          // SysTick count at which the sleep ends, sorts the sleep list
+    const OS_SelectObjectTypeDef *waitObjects;  // Objects being waited for in OS_WaitAny, NULL if not waiting
+    uint32_t waitCount;
+    int32_t waitResult;
+    OS_TCBTypeDef *nextSelectWaiter;            // Next thread waiting in OS_WaitAny, in priority order
+    uint32_t basePeriod;                        // Period in milliseconds, 0 if the thread is not periodic
+    uint32_t periodTicks;
+    uint64_t nextRelease;                       // SysTick count of the next release of a periodic thread
     uint32_t hasFullyRan;
+    uint32_t tableDriven;                       // Released by the schedule table instead of a period
+    OS_ServerTypeDef *server;                   // Server whose budget the thread uses, NULL if not limited
     OS_StateTypeDef state;
+#if THREAD_STATS_ENABLED
+    uint64_t runTime;                           // Total BSP_GetTimestamp ticks spent running
+    uint32_t voluntarySwitches;                 // Times switched out because it blocked, slept or relinquished
+    uint32_t preemptiveSwitches;                // Times switched out by a time slice or a higher priority thread
+    uint32_t lastActivated;                     // Timestamp of when the thread was last switched in
+#endif
+#if WAKEUP_LATENCY_ENABLED
+    uint32_t wakeupPending;                     // Became ready and has not been dispatched since
+    uint32_t readyTimestamp;
+    OS_LatencyStatsTypeDef wakeupLatency;
+#endif
+#if THREAD_BUDGET_ENABLED
+    uint32_t budget;                            // BSP_GetTimestamp ticks allowed per window, 0 if not limited
+    uint32_t budgetUsed;                        // Time used in the current window
+    uint32_t budgetWindowTicks;
+    uint64_t budgetWindowEnd;                   // SysTick count at which the next window starts
+    uint32_t budgetThrottled;                   // 1 while the budget is used up and the thread is not scheduled
+    uint32_t budgetOverruns;                    // Windows in which the thread was throttled
+    OS_TCBTypeDef *nextBudgeted;                // Next thread in the budget list, ordered by budgetWindowEnd
+#endif
 };
 
 
 /* -------------------------------------------- Test helper functions -------------------------------------------- */
 #if TEST
 void OS_ResetState(void);
-void SysTick_Handler(void);
 #endif
 
 
@@ -62,9 +107,62 @@ void OS_Init(void (*idleFunction)(void *), StackElementTypeDef *idleStackPtr, ui
  */
 void OS_Launch(void);
 
+/**
+ * @brief: SysTick interrupt handler, drives time slicing, sleeping, periodic threads and the schedule table
+ */
+void SysTick_Handler(void);
+
 
 /* --------------------------------------------- Utility functions ---------------------------------------------- */
+// Core clock cycles in one SysTick period, SYSCLOCK_FREQUENCY is in MHz
+#define OS_CYCLES_PER_TICK ((uint32_t)SYSCLOCK_FREQUENCY * 1000u * SYS_TICK_PERIOD_MILLIS)
+
+/**
+ * @brief: Reads the amount of SysTicks since startup. The 64-bit value is read again until two reads match, so it
+ *         can not be torn by the SysTick interrupt updating it in between the two halves.
+ */
 uint64_t OS_GetSysTickCount(void);
 
+/**
+ * @brief: Reads a monotonic time in core clock cycles, combining the SysTick count with the cycles elapsed in the
+ *         current tick. Lock free, can be called from threads, ISRs and inside critical sections.
+ * @return: Cycles since startup
+ */
+uint64_t OS_GetTimeCycles(void);
+
+/**
+ * @brief: Reads the monotonic time of OS_GetTimeCycles in nanoseconds
+ */
+uint64_t OS_GetTimeNs(void);
+
+/**
+ * @brief: Converts core clock cycles to nanoseconds, correct for about 7 years of cycles at 80 MHz
+ */
+uint64_t OS_CyclesToNs(uint64_t cycles);
+
+/**
+ * @brief: Converts nanoseconds to core clock cycles, rounding down
+ */
+uint64_t OS_NsToCycles(uint64_t nanos);
+
+/**
+ * @brief: Converts core clock cycles to microseconds, rounding down
+ */
+uint64_t OS_CyclesToMicros(uint64_t cycles);
+
+/**
+ * @brief: Converts a time to SysTicks, rounding up so that the time is never shorter than asked for
+ * @param millis: The time in milliseconds
+ * @return: The amount of SysTicks, at least one
+ */
+uint32_t OS_MillisToTicks(uint32_t millis);
+
+/**
+ * @brief: Converts a sleep time to the SysTick count at which it ends. Sleeps always last at least one SysTick.
+ * @param millis: Time to sleep in milliseconds, or OS_WAIT_FOREVER
+ * @return: The SysTick count, UINT64_MAX for OS_WAIT_FOREVER
+ */
+uint64_t OS_WakeTickFromMillis(uint32_t millis);
+
 
 #endif //MRTOS_OS_CORE_H
@@ -0,0 +1,104 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_CRITICAL_H
+#define SIMPLERTOS_OS_CRITICAL_H
+
+#include <assert.h>
+#include "mrtos_config.h"
+#include "stdint.h"
+#include "bsp.h"
+
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * The kernel enters its critical sections through these macros. With CRITICAL_PROFILING_ENABLED every outermost
+ * critical section is timed with BSP_GetTimestamp, and the duration is recorded for the call site that entered it.
+ * Nested sections are part of the outer one, since interrupts stay disabled until the outermost one exits.
+ */
+#if CRITICAL_PROFILING_ENABLED
+#define OS_CRITICAL_ENTER() OS_CriticalProfiledEnter(__FILE__, __LINE__)
+#define OS_CRITICAL_EXIT(pri) OS_CriticalProfiledExit(pri)
+#else
+#define OS_CRITICAL_ENTER() OS_CriticalEnter()
+#define OS_CRITICAL_EXIT(pri) OS_CriticalExit(pri)
+#endif
+
+/*
+ * Kernel functions that can be called from ISRs check with this that the calling interrupt is not above
+ * MAX_SYSCALL_INTERRUPT_PRIORITY. Such an interrupt is not masked by the critical sections, so it would corrupt the
+ * kernel state instead of waiting for the section to end.
+ */
+#if SYSCALL_PRIORITY_CHECK_ENABLED && TEST
+// Host tests count the violations instead of aborting, so that the check itself can be tested
+extern uint32_t osSyscallPriorityViolations;
+#define OS_ASSERT_SYSCALL_PRIORITY()                                                                                \
+    do {                                                                                                            \
+        if (BSP_GetActiveInterruptPriority() < MAX_SYSCALL_INTERRUPT_PRIORITY) {                                    \
+            osSyscallPriorityViolations++;                                                                          \
+        }                                                                                                           \
+    } while (0)
+#elif SYSCALL_PRIORITY_CHECK_ENABLED
+#define OS_ASSERT_SYSCALL_PRIORITY() assert(BSP_GetActiveInterruptPriority() >= MAX_SYSCALL_INTERRUPT_PRIORITY)
+#else
+#define OS_ASSERT_SYSCALL_PRIORITY()
+#endif
+
+typedef struct {
+    const char *file;               // NULL if the entry is unused
+    uint32_t line;
+    uint32_t count;
+    uint32_t maxDuration;
+    uint32_t histogram[CRITICAL_HISTOGRAM_BUCKETS];    // Bucket n counts durations of [2^(n-1), 2^n) ticks
+} OS_CriticalSiteTypeDef;
+
+typedef struct {
+    uint32_t depth;                 // Current nesting depth
+    uint32_t maxDepth;
+    uint32_t droppedSections;       // Sections from call sites that did not fit the table
+    const char *openFile;           // Call site and start time of the outermost section currently open
+    uint32_t openLine;
+    uint32_t openTimestamp;
+    OS_CriticalSiteTypeDef sites[CRITICAL_PROFILING_SITES];
+} OS_CriticalProfileTypeDef;
+
+extern OS_CriticalProfileTypeDef osCriticalProfile;
+
+
+/* --------------------------------------------- Profiling functions ----------------------------------------------- */
+/**
+ * @brief: Enters a critical section and starts timing it if it is the outermost one. Use through OS_CRITICAL_ENTER.
+ * @param file: File of the call site
+ * @param line: Line of the call site
+ * @return: The value of BASEPRI register before masking interrupts
+ */
+uint32_t OS_CriticalProfiledEnter(const char *file, uint32_t line);
+
+/**
+ * @brief: Records the duration if the outermost section is exited, and exits the critical section.
+ *         Use through OS_CRITICAL_EXIT.
+ * @param priority: Value returned by the matching OS_CriticalProfiledEnter
+ */
+void OS_CriticalProfiledExit(uint32_t priority);
+
+/**
+ * @brief: Finds the call site with the longest critical section
+ * @return: The site, or NULL if nothing has been recorded
+ */
+const OS_CriticalSiteTypeDef *OS_CriticalGetWorstSite(void);
+
+/**
+ * @brief: Clears the recorded statistics, must not be called from inside a critical section
+ */
+void OS_CriticalProfileReset(void);
+
+/**
+ * @brief: Finds the log2 histogram bucket of a value, shared by the kernel's timing histograms
+ * @param value: The value to sort, in timestamp ticks
+ * @param buckets: Number of buckets in the histogram, the last one also holds everything larger
+ * @return: 0 for a value of 0, otherwise n for a value in [2^(n-1), 2^n)
+ */
+uint32_t OS_HistogramBucket(uint32_t value, uint32_t buckets);
+
+#endif //SIMPLERTOS_OS_CRITICAL_H
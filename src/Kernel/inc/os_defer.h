@@ -0,0 +1,63 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_DEFER_H
+#define SIMPLERTOS_OS_DEFER_H
+
+#include "mrtos_config.h"
+#include "stdint.h"
+#include "os_semaphore.h"
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * Deferred calls let an ISR hand the slow part of its work to a single kernel worker thread, so every bottom half
+ * shares one TCB and one stack. An ISR reserves a slot of the queue in a critical section of a few instructions, fills
+ * it outside of the critical section and then marks it ready. The worker runs every ready call in queue order back to
+ * back, and only waits for the semaphore again once the queue is empty.
+ */
+typedef void (*OS_DeferredFunctionTypeDef)(void *arg);
+
+typedef struct {
+    // Volatile like the flag, so that the compiler can not move the stores of the call after the store of the flag
+    volatile OS_DeferredFunctionTypeDef function;
+    void *volatile arg;
+    volatile uint32_t ready;    // Set by the producer once the slot has been filled
+} OS_DeferredCallTypeDef;
+
+typedef struct {
+    volatile uint32_t head;     // Next slot the worker runs, only written by the worker
+    volatile uint32_t tail;     // Next slot to reserve, only written inside critical sections
+    uint32_t dropped;           // Calls that did not fit the queue
+    uint32_t highWater;         // Most calls ever queued at once
+    OS_SemaphoreObjectTypeDef semaphore;    // Wakes the worker
+    OS_DeferredCallTypeDef calls[DEFER_QUEUE_LENGTH];
+} OS_DeferQueueTypeDef;
+
+extern OS_DeferQueueTypeDef osDeferQueue;
+
+
+/* ------------------------------------------- Deferred call functions --------------------------------------------- */
+/**
+ * @brief: Empties the queue and creates the worker thread with DEFER_WORKER_PRIORITY, call before OS_Launch
+ * @return: 1 if the worker thread was created
+ */
+uint32_t OS_DeferInit(void);
+
+/**
+ * @brief: Queues a function to be called from the worker thread. Can be called from ISRs and threads, never blocks.
+ *         The worker is woken with OS_SignalFromISR, so an ISR should call OS_YieldFromISR before returning. A
+ *         thread is switched away from right away if the worker has a higher priority.
+ * @param function: The function to call
+ * @param arg: Argument passed to the function
+ * @return: 1 if the call was queued, 0 if the queue was full
+ */
+uint32_t OS_DeferCall(OS_DeferredFunctionTypeDef function, void *arg);
+
+/**
+ * @brief: Runs every ready call in the queue, used by the worker thread
+ * @return: The amount of calls that were run
+ */
+uint32_t OS_DeferRunPending(void);
+
+#endif //SIMPLERTOS_OS_DEFER_H
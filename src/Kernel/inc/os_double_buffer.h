@@ -0,0 +1,89 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_DOUBLE_BUFFER_H
+#define SIMPLERTOS_OS_DOUBLE_BUFFER_H
+
+#include "mrtos_config.h"
+#include "os_semaphore.h"
+#include "stdint.h"
+
+
+/* --------------------------------------------- Storage declaration ----------------------------------------------- */
+#define OS_DOUBLE_BUFFER_STR_(x) #x
+#define OS_DOUBLE_BUFFER_STR(x) OS_DOUBLE_BUFFER_STR_(x)
+
+// Size of one half rounded up to the alignment, so that the second half is aligned as well
+#define OS_DOUBLE_BUFFER_HALF_SIZE(halfSizeBytes) \
+    ((((halfSizeBytes) + DOUBLE_BUFFER_ALIGNMENT - 1) / DOUBLE_BUFFER_ALIGNMENT) * DOUBLE_BUFFER_ALIGNMENT)
+
+/**
+ * @brief: Declares correctly aligned and padded storage for a double buffer with halves of halfSizeBytes bytes
+ */
+#if defined(__ICCARM__)
+#define OS_DOUBLE_BUFFER_DECLARE(name, halfSizeBytes) \
+    _Pragma(OS_DOUBLE_BUFFER_STR(data_alignment=DOUBLE_BUFFER_ALIGNMENT)) \
+    uint8_t name[2*OS_DOUBLE_BUFFER_HALF_SIZE(halfSizeBytes)]
+#else
+#define OS_DOUBLE_BUFFER_DECLARE(name, halfSizeBytes) \
+    uint8_t name[2*OS_DOUBLE_BUFFER_HALF_SIZE(halfSizeBytes)] __attribute__((aligned(DOUBLE_BUFFER_ALIGNMENT)))
+#endif
+
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * Ping-pong buffer for handing DMA filled blocks to a thread without copying. The DMA fills one half while the thread
+ * processes the other. When the DMA completes a half, the ISR calls OS_DoubleBufferSwap, which hands the half to the
+ * thread and returns the half the DMA should fill next. If the thread still has not released its previous half, or
+ * has not even acquired the previously completed one, the swap is an overrun: the newest half is dropped and the DMA
+ * is told to fill the same half again, so the thread never sees a half that is being written to.
+ */
+typedef struct {
+    uint8_t *dataPtr;
+    uint32_t halfSizeBytes;
+    uint32_t dmaHalf;           // Index of the half currently being filled by the DMA
+    uint32_t readyHalf;         // Index of the half most recently completed by the DMA
+    uint32_t pending;           // 1 if the ready half has not been acquired yet
+    uint32_t consumerOwns;      // 1 between acquire and release
+    uint32_t overruns;
+    OS_SemaphoreObjectTypeDef semaphore;
+} OS_DoubleBufferTypeDef;
+
+
+/* -------------------------------------------- Double buffer functions -------------------------------------------- */
+/**
+ * @brief: Initializes a double buffer. The DMA should start filling the half returned by OS_DoubleBufferDMATarget.
+ * @param doubleBuffer: The double buffer to initialize
+ * @param dataPtr: Storage declared with OS_DOUBLE_BUFFER_DECLARE
+ * @param halfSizeBytes: Size of one half, must be a multiple of DOUBLE_BUFFER_ALIGNMENT
+ */
+void OS_DoubleBufferInit(OS_DoubleBufferTypeDef *doubleBuffer, void *dataPtr, uint32_t halfSizeBytes);
+
+/**
+ * @brief: Returns the half that the DMA is currently expected to fill
+ */
+void *OS_DoubleBufferDMATarget(OS_DoubleBufferTypeDef *doubleBuffer);
+
+/**
+ * @brief: Marks the half being filled by the DMA as complete and wakes the consumer. Called from the DMA ISR, which
+ *         must call OS_YieldFromISR before returning.
+ * @param doubleBuffer: The double buffer whose DMA half was completed
+ * @return: The half that the DMA should fill next
+ */
+void *OS_DoubleBufferSwap(OS_DoubleBufferTypeDef *doubleBuffer);
+
+/**
+ * @brief: Blocks until the DMA has completed a half, and hands it to the calling thread
+ * @param doubleBuffer: The double buffer to acquire a half from
+ * @return: Pointer to the completed half, valid until OS_DoubleBufferRelease is called
+ */
+void *OS_DoubleBufferAcquire(OS_DoubleBufferTypeDef *doubleBuffer);
+
+/**
+ * @brief: Gives the acquired half back, so that the DMA can fill it again
+ * @param doubleBuffer: The double buffer to release the half to
+ */
+void OS_DoubleBufferRelease(OS_DoubleBufferTypeDef *doubleBuffer);
+
+#endif //SIMPLERTOS_OS_DOUBLE_BUFFER_H
@@ -0,0 +1,97 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_HEAP_H
+#define SIMPLERTOS_OS_HEAP_H
+
+#include "mrtos_config.h"
+#include "stdint.h"
+
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * Two-Level Segregated Fit heap for variable size allocations with O(1) worst case allocation and freeing.
+ * Free blocks are kept in lists segregated first by power of two (first level) and then linearly within that power
+ * of two (second level), with a bitmap for each level. Finding a suitable list is a couple of bit scans, and freed
+ * blocks are immediately coalesced with free physical neighbours.
+ */
+#define HEAP_ALIGN_SIZE_LOG2 (sizeof(void *) == 8 ? 3 : 2)
+#define HEAP_ALIGN_SIZE (1U << HEAP_ALIGN_SIZE_LOG2)
+#define HEAP_SL_INDEX_COUNT (1U << HEAP_SL_INDEX_COUNT_LOG2)
+#define HEAP_FL_INDEX_SHIFT (HEAP_SL_INDEX_COUNT_LOG2 + HEAP_ALIGN_SIZE_LOG2)
+#define HEAP_FL_INDEX_COUNT (HEAP_FL_INDEX_MAX - HEAP_FL_INDEX_SHIFT + 1)
+
+typedef struct OS_HeapBlockStruct OS_HeapBlockTypeDef;
+struct OS_HeapBlockStruct {
+    OS_HeapBlockTypeDef *prevPhys;      // Physically previous block, NULL for the first block
+    uintptr_t size;                     // Payload size, the two lowest bits are the free and previous free flags
+    OS_HeapBlockTypeDef *nextFree;      // Free list links, only valid while the block is free (part of the payload)
+    OS_HeapBlockTypeDef *prevFree;
+};
+
+typedef struct {
+    uint32_t flBitmap;
+    uint32_t slBitmap[HEAP_FL_INDEX_COUNT];
+    OS_HeapBlockTypeDef *freeLists[HEAP_FL_INDEX_COUNT][HEAP_SL_INDEX_COUNT];
+    OS_HeapBlockTypeDef *firstBlock;
+    uint32_t totalBytes;        // Bytes usable for blocks, including the block headers
+    uint32_t usedBytes;         // Bytes of allocated blocks, including the block headers
+    uint32_t peakUsedBytes;
+    uint32_t allocations;
+    uint32_t failed;
+} OS_HeapTypeDef;
+
+typedef struct {
+    uint32_t totalBytes;
+    uint32_t usedBytes;
+    uint32_t peakUsedBytes;
+    uint32_t freeBytes;
+    uint32_t largestFreeBlock;
+    uint32_t freeBlocks;
+    uint32_t fragmentationPercent;  // How much of the free memory is not in the largest free block
+    uint32_t allocations;
+    uint32_t failed;
+} OS_HeapStatsTypeDef;
+
+
+/* ------------------------------------------------ Heap functions ------------------------------------------------- */
+/**
+ * @brief: Initializes a heap on top of the provided memory
+ * @param heap: The heap to initialize
+ * @param memPtr: The memory to manage, does not need to be aligned
+ * @param sizeBytes: Size of the memory in bytes
+ */
+void OS_HeapInit(OS_HeapTypeDef *heap, void *memPtr, uint32_t sizeBytes);
+
+/**
+ * @brief: Allocates memory from the heap in O(1) time, can be called from ISRs
+ * @param heap: The heap to allocate from
+ * @param sizeBytes: The amount of bytes needed
+ * @return: Pointer aligned to HEAP_ALIGN_SIZE, or NULL if no large enough free block exists
+ */
+void *OS_HeapAlloc(OS_HeapTypeDef *heap, uint32_t sizeBytes);
+
+/**
+ * @brief: Returns memory to the heap in O(1) time, can be called from ISRs
+ * @param heap: The heap the memory was allocated from
+ * @param ptr: Pointer returned by OS_HeapAlloc, NULL is ignored
+ */
+void OS_HeapFree(OS_HeapTypeDef *heap, void *ptr);
+
+/**
+ * @brief: Walks every block of the heap and verifies that the block headers, the free lists and the bitmaps agree.
+ *         Runs in time linear to the amount of blocks, meant for debugging and tests.
+ * @param heap: The heap to check
+ * @return: 1 if the heap is intact
+ */
+uint32_t OS_HeapCheck(OS_HeapTypeDef *heap);
+
+/**
+ * @brief: Fills in usage and fragmentation statistics. Runs in time linear to the amount of free blocks.
+ * @param heap: The heap to inspect
+ * @param stats: Destination for the statistics
+ */
+void OS_HeapGetStats(OS_HeapTypeDef *heap, OS_HeapStatsTypeDef *stats);
+
+#endif //SIMPLERTOS_OS_HEAP_H
@@ -0,0 +1,54 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_LATEST_VALUE_H
+#define SIMPLERTOS_OS_LATEST_VALUE_H
+
+#include "stdint.h"
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * Latest-value register for publishing state that readers only ever need the newest copy of. The writer never blocks
+ * and readers never block or cause a context switch, so neither side can cause priority inheritance.
+ *
+ * The storage holds two slots. The writer always fills the slot readers are not pointed at, and the sequence counter
+ * is odd while a write is in progress. A reader copies the last completed slot and compares the sequence before and
+ * after; it only has to retry if the writer completed a publish and started overwriting that same slot meanwhile,
+ * which on a single core means the writer preempted the reader twice. A reader preempting the writer never spins.
+ * Only a single writer is supported.
+ */
+typedef struct {
+    volatile uint32_t sequence;
+    uint32_t dataSizeBytes;
+    uint32_t retries;           // Amount of torn reads detected and retried, for all readers combined
+    uint8_t *dataPtr;
+} OS_LatestValueTypeDef;
+
+
+/* ------------------------------------------- Latest value functions ---------------------------------------------- */
+/**
+ * @brief: Initializes a latest value register. The value read before the first write is the initial contents of
+ *         the first slot of the storage.
+ * @param latest: The register to initialize
+ * @param dataPtr: Pointer to the pre-allocated storage, must fit 2*dataSizeBytes bytes
+ * @param dataSizeBytes: Size of the published value in bytes
+ */
+void OS_LatestValueInit(OS_LatestValueTypeDef *latest, void *dataPtr, uint32_t dataSizeBytes);
+
+/**
+ * @brief: Publishes a new value. Never blocks, must only be called from a single thread or ISR.
+ * @param latest: The register to write to
+ * @param dataPtr: Pointer to the value to publish
+ */
+void OS_LatestValueWrite(OS_LatestValueTypeDef *latest, const void *dataPtr);
+
+/**
+ * @brief: Copies the most recently published value. Never blocks, retries if the copy was torn by the writer.
+ * @param latest: The register to read from
+ * @param dataPtr: Pointer to the destination, must fit dataSizeBytes bytes
+ * @return: The amount of writes published before the returned value, can be used to detect whether it is new
+ */
+uint32_t OS_LatestValueRead(OS_LatestValueTypeDef *latest, void *dataPtr);
+
+#endif //SIMPLERTOS_OS_LATEST_VALUE_H
@@ -0,0 +1,78 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_POOL_H
+#define SIMPLERTOS_OS_POOL_H
+
+#include "os_semaphore.h"
+#include "stdint.h"
+
+
+/* --------------------------------------------- Storage declaration ----------------------------------------------- */
+// Free blocks store the free list link in themselves, so blocks are rounded up to a multiple of the pointer size
+#define OS_POOL_BLOCK_SIZE(blockSizeBytes) ((((blockSizeBytes) + sizeof(void *) - 1) / sizeof(void *)) * sizeof(void *))
+
+/**
+ * @brief: Declares correctly aligned storage for a pool of blocks of blockSizeBytes bytes
+ */
+#define OS_POOL_DECLARE(name, blockSizeBytes, blocks) \
+    void *name[(OS_POOL_BLOCK_SIZE(blockSizeBytes) / sizeof(void *)) * (blocks)]
+
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+typedef struct OS_PoolStruct {
+    void *freeList;
+    void *handoffList;          // Blocks freed while threads were waiting, reserved for the woken threads
+    uint8_t *memPtr;
+    uint32_t blockSize;
+    uint32_t blocks;
+    uint32_t inUse;
+    uint32_t highWater;
+    uint32_t failed;            // Amount of OS_PoolAlloc calls that found the pool empty
+    OS_SemaphoreObjectTypeDef semaphore;    // Negative value counts the threads waiting in OS_PoolAllocBlocking
+} OS_PoolTypeDef;
+
+
+/* ------------------------------------------------ Pool functions ------------------------------------------------- */
+/**
+ * @brief: Initializes a pool of fixed size blocks. Allocation and freeing are O(1).
+ * @param pool: The pool to initialize
+ * @param memPtr: Storage declared with OS_POOL_DECLARE
+ * @param blockSize: Size of a block in bytes, must be OS_POOL_BLOCK_SIZE rounded
+ * @param blocks: How many blocks the storage has been allocated for
+ */
+void OS_PoolInit(OS_PoolTypeDef *pool, void *memPtr, uint32_t blockSize, uint32_t blocks);
+
+/**
+ * @brief: Allocates a block from the pool. Never blocks, can be called from ISRs.
+ * @param pool: The pool to allocate from
+ * @return: Pointer to the block, or NULL if the pool is empty
+ */
+void *OS_PoolAlloc(OS_PoolTypeDef *pool);
+
+/**
+ * @brief: Allocates a block from the pool, blocking the thread until one is freed if the pool is empty.
+ *         Must not be called from ISRs.
+ * @param pool: The pool to allocate from
+ * @return: Pointer to the block
+ */
+void *OS_PoolAllocBlocking(OS_PoolTypeDef *pool);
+
+/**
+ * @brief: Returns a block to the pool, or hands it directly to a thread waiting in OS_PoolAllocBlocking.
+ *         Must not be called from ISRs, as waking a waiter may suspend the caller. ISRs use OS_PoolFreeFromISR.
+ * @param pool: The pool the block was allocated from
+ * @param block: The block to free
+ */
+void OS_PoolFree(OS_PoolTypeDef *pool, void *block);
+
+/**
+ * @brief: Same as OS_PoolFree, but never suspends the caller, so it is the one to use from ISRs. If a higher priority
+ *         waiter is woken the reschedule is deferred to OS_YieldFromISR.
+ * @param pool: The pool the block was allocated from
+ * @param block: The block to free
+ */
+void OS_PoolFreeFromISR(OS_PoolTypeDef *pool, void *block);
+
+#endif //SIMPLERTOS_OS_POOL_H
@@ -0,0 +1,67 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_PROFILER_H
+#define SIMPLERTOS_OS_PROFILER_H
+
+#include "mrtos_config.h"
+#include "stdint.h"
+
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * Statistical profiler: every SysTick the PC of the interrupted code is counted in a histogram keyed by PC and
+ * thread id. The histogram is an open addressing hash table, so a sample costs a hash and usually a single probe.
+ * Dump osProfilerBuffer with a debugger and symbolize it with tools/profile_symbolize.py against the ELF.
+ * Keep the layout in sync with the script.
+ */
+#define PROFILER_MAGIC 0x464F5250   // "PROF" in little endian
+
+typedef struct {
+    uint32_t pc;
+    uint32_t count;                 // 0 if the bucket is empty
+    uint8_t threadId;
+    uint8_t reserved[3];
+} OS_ProfilerEntryTypeDef;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t entrySize;
+    uint32_t capacity;
+    uint32_t samples;               // Samples taken, including the dropped ones
+    uint32_t dropped;               // Samples of new (PC, thread) pairs that did not fit the table
+    OS_ProfilerEntryTypeDef entries[PROFILER_BUCKETS];
+} OS_ProfilerBufferTypeDef;
+
+
+#if PROFILER_ENABLED
+extern OS_ProfilerBufferTypeDef osProfilerBuffer;
+
+/* ----------------------------------------------- Profiler functions ---------------------------------------------- */
+/**
+ * @brief: SysTick entry point to use in the vector table instead of SysTick_Handler, written in assembly. Reads the
+ *         stacked PC of the interrupted code and passes it to OS_ProfilerSysTick.
+ */
+void OS_ProfilerSysTickEntry(void);
+
+/**
+ * @brief: Samples the PC for the running thread, then runs the normal SysTick handler
+ * @param pc: PC of the code the SysTick interrupted
+ */
+void OS_ProfilerSysTick(uint32_t pc);
+
+/**
+ * @brief: Counts a single sample in the histogram. Can be called from any timer interrupt with interrupts disabled.
+ * @param pc: PC of the interrupted code
+ * @param threadId: Id of the thread that was interrupted
+ */
+void OS_ProfilerSample(uint32_t pc, uint8_t threadId);
+
+/**
+ * @brief: Empties the histogram
+ */
+void OS_ProfilerReset(void);
+#endif
+
+#endif //SIMPLERTOS_OS_PROFILER_H
@@ -0,0 +1,113 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_RING_H
+#define SIMPLERTOS_OS_RING_H
+
+#include "stdint.h"
+#include "bsp.h"
+#include "os_critical.h"
+
+/*
+ * Generator for ring buffers whose element type and capacity are fixed at compile time. Compared to OS_Buffer, the
+ * index math folds into a mask and every element is copied with a typed load and store instead of memcpy.
+ * Like OS_Buffer, writing to a full ring overwrites the oldest elements and counts them as missed.
+ *
+ * OS_RING_DEFINE(SampleRing, uint16_t, 64) defines SampleRingTypeDef and the functions
+ *   void SampleRingInit(SampleRingTypeDef *ring)
+ *   void SampleRingPut(SampleRingTypeDef *ring, uint16_t value)
+ *   uint32_t SampleRingGet(SampleRingTypeDef *ring, uint16_t *value)        -> 1 if a value was read
+ *   void SampleRingWrite(SampleRingTypeDef *ring, const uint16_t *src, uint32_t count)
+ *   uint32_t SampleRingRead(SampleRingTypeDef *ring, uint16_t *dest, uint32_t count)  -> amount read
+ *   uint32_t SampleRingCount(SampleRingTypeDef *ring)                        -> amount of unread elements
+ *
+ * Capacity has to be a power of two, anything else fails to compile.
+ */
+#define OS_RING_DEFINE(name, type, capacity)                                                                        \
+    typedef char name##CapacityMustBePowerOfTwo[((capacity) > 0 && ((capacity) & ((capacity) - 1)) == 0) ? 1 : -1]; \
+                                                                                                                    \
+    typedef struct {                                                                                                \
+        uint32_t readCount;                                                                                         \
+        uint32_t writeCount;                                                                                        \
+        uint32_t missed;                                                                                            \
+        type data[capacity];                                                                                        \
+    } name##TypeDef;                                                                                                \
+                                                                                                                    \
+    static inline void name##Init(name##TypeDef *ring) {                                                            \
+        ring->readCount = 0;                                                                                        \
+        ring->writeCount = 0;                                                                                       \
+        ring->missed = 0;                                                                                           \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline uint32_t name##Count(name##TypeDef *ring) {                                                       \
+        return ring->writeCount - ring->readCount;                                                                  \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline void name##Put(name##TypeDef *ring, type value) {                                                 \
+        uint32_t pri = OS_CRITICAL_ENTER();                                                                         \
+        if (ring->writeCount - ring->readCount == (capacity)) {                                                     \
+            ring->readCount++;                                                                                      \
+            ring->missed++;                                                                                         \
+        }                                                                                                           \
+        ring->data[ring->writeCount & ((capacity) - 1)] = value;                                                    \
+        ring->writeCount++;                                                                                         \
+        OS_CRITICAL_EXIT(pri);                                                                                      \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline uint32_t name##Get(name##TypeDef *ring, type *value) {                                            \
+        uint32_t pri = OS_CRITICAL_ENTER();                                                                         \
+        if (ring->writeCount == ring->readCount) {                                                                  \
+            OS_CRITICAL_EXIT(pri);                                                                                  \
+            return 0;                                                                                               \
+        }                                                                                                           \
+        *value = ring->data[ring->readCount & ((capacity) - 1)];                                                    \
+        ring->readCount++;                                                                                          \
+        OS_CRITICAL_EXIT(pri);                                                                                      \
+        return 1;                                                                                                   \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline void name##Write(name##TypeDef *ring, const type *src, uint32_t count) {                          \
+        uint32_t pri = OS_CRITICAL_ENTER();                                                                         \
+        /* Only the newest elements can fit the ring, skip the ones that would be overwritten by this write */      \
+        if (count > (capacity)) {                                                                                   \
+            ring->missed += count - (capacity);                                                                     \
+            src += count - (capacity);                                                                              \
+            count = (capacity);                                                                                     \
+        }                                                                                                           \
+        uint32_t unread = ring->writeCount - ring->readCount;                                                       \
+        if (unread + count > (capacity)) {                                                                          \
+            ring->missed += unread + count - (capacity);                                                            \
+            ring->readCount += unread + count - (capacity);                                                         \
+        }                                                                                                           \
+        /* Copy in at most two contiguous spans, so the loops carry no index math and can be vectorized */          \
+        uint32_t index = ring->writeCount & ((capacity) - 1);                                                       \
+        uint32_t first = count < (capacity) - index ? count : (capacity) - index;                                   \
+        for (uint32_t i = 0; i < first; i++) {                                                                      \
+            ring->data[index + i] = src[i];                                                                         \
+        }                                                                                                           \
+        for (uint32_t i = first; i < count; i++) {                                                                  \
+            ring->data[i - first] = src[i];                                                                         \
+        }                                                                                                           \
+        ring->writeCount += count;                                                                                  \
+        OS_CRITICAL_EXIT(pri);                                                                                      \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline uint32_t name##Read(name##TypeDef *ring, type *dest, uint32_t count) {                            \
+        uint32_t pri = OS_CRITICAL_ENTER();                                                                         \
+        uint32_t unread = ring->writeCount - ring->readCount;                                                       \
+        count = count > unread ? unread : count;                                                                    \
+        uint32_t index = ring->readCount & ((capacity) - 1);                                                        \
+        uint32_t first = count < (capacity) - index ? count : (capacity) - index;                                   \
+        for (uint32_t i = 0; i < first; i++) {                                                                      \
+            dest[i] = ring->data[index + i];                                                                        \
+        }                                                                                                           \
+        for (uint32_t i = first; i < count; i++) {                                                                  \
+            dest[i] = ring->data[i - first];                                                                        \
+        }                                                                                                           \
+        ring->readCount += count;                                                                                   \
+        OS_CRITICAL_EXIT(pri);                                                                                      \
+        return count;                                                                                               \
+    }
+
+#endif //SIMPLERTOS_OS_RING_H
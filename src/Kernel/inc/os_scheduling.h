@@ -28,6 +28,33 @@ void OS_Suspend(OS_Suspend_Cause cause);
  */
 void OS_Sleep(uint32_t milliseconds);
 
+/**
+ * @brief: Sleeps until a period has passed since the previous wake up, so that a loop doing work and sleeping does not
+ *         drift by the time the work takes. Initialize lastWakeTick with OS_GetSysTickCount before the first call.
+ * @param lastWakeTick: SysTick count of the previous wake up, advanced by the period
+ * @param periodMillis: Time between wake ups, rounded up to whole SysTicks
+ * @return: 1 if the thread slept, 0 if the wake up time had already passed and the thread kept running
+ */
+uint32_t OS_SleepUntil(uint64_t *lastWakeTick, uint32_t periodMillis);
+
+/**
+ * @brief: Flags that an ISR has made a thread ready that should preempt the running one. Nothing is switched until
+ *         the ISR calls OS_YieldFromISR.
+ */
+void OS_RequestRescheduleFromISR(void);
+
+/**
+ * @brief: Triggers the scheduler if any FromISR function requested it. Should be the last kernel call of an ISR that
+ *         used FromISR functions, so that any number of wake ups from one interrupt cause a single context switch.
+ */
+void OS_YieldFromISR(void);
+
+/**
+ * @brief: Thread context counterpart of OS_YieldFromISR, for threads that used FromISR functions. The switch is not
+ *         counted as a preemption, the thread gave up the CPU itself.
+ */
+void OS_YieldIfPending(void);
+
 void OS_Schedule(void);
 
 #endif //MRTOS_OS_SCHEDULING_H
@@ -0,0 +1,64 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_SELECT_H
+#define SIMPLERTOS_OS_SELECT_H
+
+#include "os_core.h"
+#include "stdint.h"
+
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+typedef enum {
+    SELECT_SEMAPHORE,           // Ready when the semaphore can be acquired, it is acquired when selected
+    SELECT_BUFFER               // Ready when the buffer has unread data, the data is not consumed when selected
+} OS_SelectObjectType;
+
+typedef struct OS_SelectObjectStruct {
+    OS_SelectObjectType type;
+    void *object;
+} OS_SelectObjectTypeDef;
+
+#define OS_WAIT_TIMEOUT (-1)
+
+
+/* ------------------------------------------------ Select functions ----------------------------------------------- */
+/**
+ * @brief: Blocks the current thread until any of the objects becomes ready, or the timeout expires. The thread is
+ *         woken once by whichever object becomes ready first, there is no polling.
+ * @param objects: Array of the objects to wait for, must stay valid while the thread is waiting
+ * @param count: Amount of objects in the array
+ * @param timeoutMillis: Maximum time to wait, 0 to only check the objects, or OS_WAIT_FOREVER
+ * @return: Index of the object that became ready, or OS_WAIT_TIMEOUT
+ */
+int32_t OS_WaitAny(const OS_SelectObjectTypeDef *objects, uint32_t count, uint32_t timeoutMillis);
+
+/**
+ * @brief: Wakes the highest priority thread waiting for the object in OS_WaitAny. Must be called inside a critical
+ *         section by the kernel object that became ready.
+ * @param object: The object that became ready
+ * @return: The thread that was woken, or NULL if no thread was waiting for the object
+ */
+OS_TCBTypeDef *OS_SelectWakeWaiter(const void *object);
+
+/**
+ * @brief: Adds a thread to the list of threads waiting in OS_WaitAny, behind the waiters of the same priority.
+ *         Must be called inside a critical section.
+ * @param thread: The waiting thread
+ */
+void OS_SelectListInsertUnlocked(OS_TCBTypeDef *thread);
+
+/**
+ * @brief: Removes a thread from the list of threads waiting in OS_WaitAny. Must be called inside a critical section.
+ * @param thread: The waiting thread
+ */
+void OS_SelectListRemoveUnlocked(OS_TCBTypeDef *thread);
+
+
+/* -------------------------------------------- Test helper functions -------------------------------------------- */
+#if TEST
+void OS_ResetSelect(void);
+#endif
+
+#endif //SIMPLERTOS_OS_SELECT_H
@@ -24,6 +24,7 @@ typedef struct OS_SemaphoreStruct {
     OS_TCBTypeDef *owner;
     uint32_t priorityHasBeenGranted;
     uint32_t priorityLevelGranted;
+    struct OS_SemaphoreStruct *nextOwned;   // Next mutex held by the same owner
 } OS_SemaphoreObjectTypeDef;
 
 /***
@@ -39,10 +40,31 @@ void OS_InitSemaphore(OS_SemaphoreObjectTypeDef *semaphoreObject, SemaphoreType
  */
 void OS_Signal(OS_SemaphoreObjectTypeDef *semaphoreObject);
 
+/**
+ * @brief: Signals a flag semaphore from an ISR. Never suspends, if a higher priority thread is woken the reschedule
+ *         is deferred to OS_YieldFromISR. Mutexes are owned by threads and can not be signaled from ISRs.
+ * @param semaphore: The flag semaphore to signal
+ */
+void OS_SignalFromISR(OS_SemaphoreObjectTypeDef *semaphoreObject);
+
 /**
  * @brief: Acquires control of a semaphore, will block the task until it gets hold of it, if it is already in use
  * @param semaphore: The semaphore to acquire
  */
 void OS_Wait(OS_SemaphoreObjectTypeDef *semaphoreObject);
 
+/**
+ * @brief: Acquires control of a semaphore if it is available, never blocks
+ * @param semaphore: The semaphore to acquire
+ * @return: 1 if the semaphore was acquired
+ */
+uint32_t OS_TryWait(OS_SemaphoreObjectTypeDef *semaphoreObject);
+
+/**
+ * @brief: Takes a thread blocked in OS_Wait off the semaphore without giving it the semaphore, and gives back any
+ *         priority its owner had inherited from the thread. Must be called inside a critical section
+ * @param thread: The blocked thread
+ */
+void OS_CancelWaitUnlocked(OS_TCBTypeDef *thread);
+
 #endif //MRTOS_OS_SEMAPHORE_H
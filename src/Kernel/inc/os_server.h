@@ -0,0 +1,61 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_SERVER_H
+#define SIMPLERTOS_OS_SERVER_H
+
+#include "mrtos_config.h"
+#include "stdint.h"
+#include "os_core.h"
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * A server is a group of threads sharing a CPU budget that is replenished at the start of every server period. The
+ * SysTick charges the tick to the server of the thread it interrupted, and once the budget is used up the threads
+ * of the server are passed over by the scheduler until the next replenishment. Aperiodic work can then run at a high
+ * priority for a good response time, while the threads below it are still guaranteed the rest of the CPU. Budgets
+ * are accounted in whole SysTicks, a thread that blocks in the middle of a tick is not charged for it.
+ */
+typedef struct OS_ServerStruct {
+    uint32_t budgetTicks;
+    uint32_t periodTicks;
+    uint32_t remaining;             // Budget left in the current period in SysTicks
+    uint64_t nextReplenish;         // SysTick count at which the budget is restored, on an absolute grid
+    uint32_t throttled;             // 1 while the budget is used up and the threads are not scheduled
+    uint32_t exhaustions;           // Periods in which the whole budget was used
+    struct OS_ServerStruct *next;
+} OS_ServerTypeDef;
+
+
+/* -------------------------------------------- Test helper functions -------------------------------------------- */
+#if TEST
+void OS_ResetServers(void);
+#endif
+
+
+/* ----------------------------------------------- Server functions ------------------------------------------------ */
+/**
+ * @brief: Initializes a server with a full budget and adds it to the servers handled by the SysTick
+ * @param server: The server to initialize, must stay allocated while the OS runs
+ * @param budgetMillis: CPU time the threads of the server can use per period, rounded up to whole SysTicks
+ * @param periodMillis: Replenishment period, rounded up to whole SysTicks
+ */
+void OS_ServerInit(OS_ServerTypeDef *server, uint32_t budgetMillis, uint32_t periodMillis);
+
+/**
+ * @brief: Makes the thread use the budget of the server, a thread belongs to at most one server
+ * @param server: The server, NULL to remove the thread from its server
+ * @param thread: The thread to attach
+ */
+void OS_ServerAttach(OS_ServerTypeDef *server, OS_TCBTypeDef *thread);
+
+/**
+ * @brief: Called by the SysTick handler, charges the tick to the server of the running thread and replenishes the
+ *         servers whose period has ended
+ * @param tickCount: The current SysTick count
+ * @return: 1 if a server was throttled or released, and the scheduler has to run
+ */
+uint32_t OS_ServerSysTick(uint64_t tickCount);
+
+#endif //SIMPLERTOS_OS_SERVER_H
@@ -0,0 +1,90 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_TABLE_H
+#define SIMPLERTOS_OS_TABLE_H
+
+#include "mrtos_config.h"
+#include "stdint.h"
+#include "os_core.h"
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * Time triggered dispatch from a static schedule table. The table lists the SysTick offsets within a hyperperiod at
+ * which each table thread is released, and is generated offline from the task declarations with
+ * tools/schedule_table_gen.py, which also makes sure that the jobs never overlap. Every SysTick looks at one entry
+ * only. Table threads run at TABLE_THREAD_PRIORITY, above everything else, and relinquish with
+ * OS_Suspend(OS_SUSPEND_RELINQUISH) when their job is done like periodic threads do. Threads of lower priority are
+ * scheduled by priority in the time the table leaves free.
+ */
+typedef struct {
+    uint32_t offset;                // SysTicks from the start of the hyperperiod
+    uint32_t task;                  // Index of the thread in the thread array of the table
+} OS_TableEntryTypeDef;
+
+typedef struct OS_ScheduleTableStruct {
+    const OS_TableEntryTypeDef *entries;    // Ordered by offset, at most one entry per offset
+    uint32_t length;
+    uint32_t hyperperiod;           // Length of the table in SysTicks, the table repeats after it
+    OS_TCBTypeDef **threads;        // Threads created with OS_CreateTableThread, indexed by the task of the entries.
+                                    // Deleted threads are set to NULL, as their TCB can be handed to a new thread.
+    uint32_t position;              // SysTick within the hyperperiod that is dispatched next
+    uint32_t nextEntry;             // First entry whose offset has not been reached yet
+    uint32_t overruns;              // Releases skipped because the thread had not finished its previous job
+    struct OS_ScheduleTableStruct *next;    // Next initialized table
+} OS_ScheduleTableTypeDef;
+
+
+/* ----------------------------------------------- Table functions ------------------------------------------------- */
+/**
+ * @brief: Creates a thread that is only released by the schedule table, with TABLE_THREAD_PRIORITY. The thread
+ *         does not run before its first entry in the table is reached.
+ * @return: Pointer to the TCB of the thread, NULL if there were no free TCBs
+ */
+OS_TCBTypeDef *OS_CreateTableThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize,
+                                    const char *identifier);
+
+/**
+ * @brief: Initializes a schedule table, asserts that the entries are ordered and inside the hyperperiod
+ * @param table: The table to initialize
+ * @param entries: Entries of the table, usually the output of tools/schedule_table_gen.py
+ * @param length: Amount of entries
+ * @param hyperperiod: Length of the table in SysTicks
+ * @param threads: Table threads, entry task n releases threads[n]. Must stay valid, the kernel clears the threads
+ *                 that get deleted from it.
+ */
+void OS_TableInit(OS_ScheduleTableTypeDef *table, const OS_TableEntryTypeDef *entries, uint32_t length,
+                  uint32_t hyperperiod, OS_TCBTypeDef **threads);
+
+/**
+ * @brief: Makes the table the active one, the hyperperiod starts from offset 0 on the next SysTick. Replaces a
+ *         table that is already active.
+ */
+void OS_TableStart(OS_ScheduleTableTypeDef *table);
+
+/**
+ * @brief: Stops dispatching the active table, jobs that were already released still run to completion
+ */
+void OS_TableStop(void);
+
+/**
+ * @brief: Called by the SysTick handler, releases the thread of the current offset of the active table. Constant time.
+ * @return: 1 if the released thread should preempt the running thread
+ */
+uint32_t OS_TableSysTick(void);
+
+/**
+ * @brief: Clears a deleted thread from the thread array of every initialized table, so that the tables do not
+ *         release the next thread that gets its TCB. Must be called inside a critical section.
+ * @param thread: The deleted table thread
+ */
+void OS_TableRemoveThreadUnlocked(OS_TCBTypeDef *thread);
+
+
+/* -------------------------------------------- Test helper functions -------------------------------------------- */
+#if TEST
+void OS_ResetTables(void);
+#endif
+
+#endif //SIMPLERTOS_OS_TABLE_H
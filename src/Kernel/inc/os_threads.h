@@ -8,9 +8,31 @@
 
 #include "mrtos_config.h"
 #include "os_core.h"
+#include "os_pool.h"
 #include "bsp.h"
 
 
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+typedef void (*OS_StackOverflowHookTypeDef)(OS_TCBTypeDef *thread);
+typedef void (*OS_BudgetHookTypeDef)(OS_TCBTypeDef *thread);
+
+// TCBs are recycled, the generation tells whether the handle still refers to the thread it was taken from
+typedef struct {
+    OS_TCBTypeDef *thread;
+    uint32_t generation;
+} OS_ThreadHandleTypeDef;
+
+typedef struct {
+    const char *identifier;
+    uint8_t id;
+    uint32_t priority;
+    uint64_t runTime;
+    uint32_t voluntarySwitches;
+    uint32_t preemptiveSwitches;
+    uint32_t lastActivated;
+} OS_ThreadStatsTypeDef;
+
+
 /* ----------------------------------------------- Global variables ----------------------------------------------- */
 extern OS_TCBTypeDef *idlePtr;
 extern OS_TCBTypeDef *runPtr;
@@ -43,11 +65,44 @@ OS_TCBTypeDef *OS_GetSleepingThreadByIdentifier(const char *identifier);
  * @param stackPtr: Pointer to the pre-allocated stack memory
  * @param: stackSize: How many elements the stack has been allocated for
  * @param: identifier: A string literal that can be used to identify this thread
- *
+ * @return: Handle to the thread, or NULL if NUM_USER_THREADS threads already exist
  */
-void OS_CreateThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, const char *identifier);
+OS_TCBTypeDef *OS_CreateThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, const char *identifier);
 
-void OS_CreatePeriodicThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, uint32_t periodMillis, const char *identifier);
+/**
+ * @brief: Creates a new thread like OS_CreateThread, but with a stack allocated from a pool. The stack is returned
+ *         to the pool when the thread is deleted.
+ * @param stackPool: Pool whose block size is the stack size in bytes
+ * @return: Handle to the thread, or NULL if no TCB or stack is free
+ */
+OS_TCBTypeDef *OS_CreateThreadFromPool(void (*function)(void *), OS_PoolTypeDef *stackPool, uint32_t priority, const char *identifier);
+
+/**
+ * @brief: Creates a thread that is released every periodMillis, and is expected to give up the CPU with
+ *         OS_Suspend(OS_SUSPEND_RELINQUISH) once it is done. Releases are at absolute SysTick counts, so they do not
+ *         drift. A release while the thread is still running is skipped.
+ * @param periodMillis: Time between releases, rounded up to whole SysTicks
+ * @return: Handle to the thread, or NULL if NUM_USER_THREADS threads already exist
+ */
+OS_TCBTypeDef *OS_CreatePeriodicThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, uint32_t periodMillis, const char *identifier);
+
+/**
+ * @brief: Creates a periodic thread like OS_CreatePeriodicThread, with its releases offset by a phase. Threads with
+ *         the same period never get released on the same SysTick if their phases in SysTicks differ modulo the
+ *         period.
+ * @param phaseMillis: Offset of the releases from creation time, rounded down to whole SysTicks
+ */
+OS_TCBTypeDef *OS_CreatePhasedPeriodicThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, uint32_t periodMillis, uint32_t phaseMillis, const char *identifier);
+
+/**
+ * @brief: Spreads the releases of all periodic threads so that as few as possible happen on the same SysTick. Two
+ *         threads with periods Ti and Tj and phases Pi and Pj are released together at some point if and only if
+ *         Pi - Pj is a multiple of gcd(Ti, Tj). Threads are placed from the highest priority down, each one at the
+ *         smallest phase that collides with the fewest threads already placed. Periods are not changed, phases given
+ *         at creation are replaced. Call after creating the periodic threads and before OS_Launch.
+ * @return: The amount of thread pairs that still share release ticks
+ */
+uint32_t OS_AssignPeriodicPhases(void);
 
 /***
  * @brief: Creates the idle thread from the parameters. Should be called before creating any user threads.
@@ -59,8 +114,172 @@ void OS_CreatePeriodicThread(void (*function)(void *), StackElementTypeDef *stkP
  */
 void OS_CreateIdleThread(void (*idleFunction)(void *), StackElementTypeDef *idleStkPtr, uint32_t stackSize);
 
+/**
+ * @brief: Deletes a thread. Mutexes held by the thread are released, it is removed from every thread list, and
+ *         threads joining it are woken up. The TCB and a pooled stack are recycled, so the pointer must not be used
+ *         after the call, use OS_DeleteThreadHandle if the thread may already have been deleted. A thread deleting
+ *         itself does not return, and is freed on the next context switch.
+ * @param thread: Handle returned when the thread was created
+ */
+void OS_DeleteThread(OS_TCBTypeDef *thread);
+
+/**
+ * @brief: Deletes the thread like OS_DeleteThread, does nothing if the thread has already been deleted, even if its
+ *         TCB now belongs to another thread
+ * @param handle: Handle taken with OS_GetThreadHandle while the thread existed
+ */
+void OS_DeleteThreadHandle(OS_ThreadHandleTypeDef handle);
+
+/**
+ * @brief: Deletes the calling thread. Returning from a thread function ends up here.
+ */
+void OS_ThreadExit(void);
+
+/**
+ * @brief: Blocks until the thread has been deleted, returns immediately if it already has been. The pointer is only
+ *         valid until the thread has been deleted, once this returns its TCB may belong to another thread. Threads
+ *         that may be joined after they have finished have to be joined with OS_JoinThreadHandle.
+ * @param thread: Handle of the thread to wait for
+ */
+void OS_JoinThread(OS_TCBTypeDef *thread);
+
+/**
+ * @brief: Blocks until the thread has been deleted like OS_JoinThread, returns immediately if it already has been,
+ *         even if its TCB now belongs to another thread
+ * @param handle: Handle taken with OS_GetThreadHandle while the thread existed
+ */
+void OS_JoinThreadHandle(OS_ThreadHandleTypeDef handle);
+
+/**
+ * @brief: Takes a handle that stays safe to use after the thread has been deleted and its TCB reused
+ * @param thread: A thread that has not been deleted
+ * @return: The handle
+ */
+OS_ThreadHandleTypeDef OS_GetThreadHandle(OS_TCBTypeDef *thread);
+
+/**
+ * @brief: Frees the TCB of a thread that deleted itself. Called by the scheduler after switching away from it.
+ */
+void OS_ReapZombieThread(void);
+
+
+/* -------------------------------------------- Stack usage functions --------------------------------------------- */
+/**
+ * @brief: Sets the function called when a stack overflow is detected. Without a hook an overflow fails an assert.
+ * @param hook: Called from the scheduler with the overflowed thread, interrupts are disabled at that point
+ */
+void OS_SetStackOverflowHook(OS_StackOverflowHookTypeDef hook);
+
+/**
+ * @brief: Finds the deepest point the stack of the thread has ever reached. Linear in the stack size.
+ * @param thread: The thread whose stack is inspected
+ * @return: Maximum amount of stack elements that have been in use
+ */
+uint32_t OS_GetStackHighWater(OS_TCBTypeDef *thread);
+
+/**
+ * @brief: Checks the canary at the bottom of the stack, and calls the overflow hook if it has been overwritten.
+ *         Called by the scheduler for the outgoing thread at every context switch if STACK_CHECK_ENABLED.
+ * @param thread: The thread whose stack is checked
+ */
+void OS_CheckThreadStack(OS_TCBTypeDef *thread);
+
+
+/* ------------------------------------------ Thread statistics functions ----------------------------------------- */
+#if THREAD_STATS_ENABLED
+/**
+ * @brief: Charges the time since the previous context switch to the running thread, and counts the switch if the
+ *         next thread is a different one. Called by the scheduler.
+ * @param nextToRun: The thread that is about to be switched in
+ * @param voluntary: 1 if the running thread gave up the CPU itself
+ */
+void OS_AccountContextSwitch(OS_TCBTypeDef *nextToRun, uint32_t voluntary);
+
+/**
+ * @brief: Takes a consistent snapshot of the statistics of every existing thread, the idle thread first
+ * @param stats: Destination array
+ * @param maxThreads: Size of the destination array
+ * @return: Amount of threads written to the array
+ */
+uint32_t OS_GetThreadStats(OS_ThreadStatsTypeDef *stats, uint32_t maxThreads);
+
+/**
+ * @brief: Calculates the share of time spent outside the idle thread since the previous call. Calls must be closer
+ *         together than the roll over period of BSP_GetTimestamp.
+ * @return: CPU load in percent
+ */
+uint32_t OS_GetCPULoad(void);
+#endif
+
+
+/* ------------------------------------------ Wakeup latency functions -------------------------------------------- */
+#if WAKEUP_LATENCY_ENABLED
+/**
+ * @brief: Records the latency of a thread that is about to be dispatched, if it has become ready since it last ran.
+ *         Called by the scheduler.
+ * @param thread: The thread that is about to be switched in
+ */
+void OS_RecordWakeupLatency(OS_TCBTypeDef *thread);
+
+/**
+ * @brief: Copies the wakeup latency statistics of a thread
+ * @param thread: The thread to inspect
+ * @param stats: Destination for the statistics
+ */
+void OS_GetWakeupLatency(OS_TCBTypeDef *thread, OS_LatencyStatsTypeDef *stats);
+
+/**
+ * @brief: Clears the wakeup latency statistics of a thread, e.g. at the start of a measurement
+ * @param thread: The thread whose statistics are cleared
+ */
+void OS_ResetWakeupLatency(OS_TCBTypeDef *thread);
+#endif
+
+
+/* -------------------------------------------- Thread budget functions ------------------------------------------- */
+#if THREAD_BUDGET_ENABLED
+/**
+ * @brief: Limits the CPU time of the thread to a budget per window, e.g. 2 ms every 10 ms. Once the thread has used
+ *         its budget it is not scheduled again before the next window, no matter its priority. Windows are on an
+ *         absolute SysTick grid starting from this call.
+ * @param thread: The thread to limit
+ * @param budgetMicros: CPU time allowed per window, 0 removes the limit
+ * @param windowMillis: Length of the window, rounded up to whole SysTicks
+ */
+void OS_SetThreadBudget(OS_TCBTypeDef *thread, uint32_t budgetMicros, uint32_t windowMillis);
+
+/**
+ * @brief: Sets the function called when a thread is throttled for using up its budget
+ * @param hook: Called from the SysTick or the scheduler with the throttled thread, interrupts are disabled at that point
+ */
+void OS_SetBudgetHook(OS_BudgetHookTypeDef hook);
+
+/**
+ * @brief: Charges the time since the previous call to the running thread, and throttles it if its budget is used up.
+ *         Called by the scheduler and the SysTick inside a critical section.
+ * @return: 1 if the running thread was throttled
+ */
+uint32_t OS_AccountBudget(void);
+
+/**
+ * @brief: Called by the SysTick handler, charges the running thread and starts a new window for the threads whose
+ *         window has ended. Only the threads whose window has ended are looked at.
+ * @param tickCount: The current SysTick count
+ * @return: 1 if a thread was throttled or released, and the scheduler has to run
+ */
+uint32_t OS_BudgetSysTick(uint64_t tickCount);
+#endif
+
 
 /* --------------------------- Exported function wrappers for thread list manipulation ---------------------------- */
+// The wrappers enter a critical section of their own, kernel paths that already hold one use the Unlocked variants.
+// The sleep list is ordered by wakeTick, the ready and blocked lists by priority.
+void OS_ReadyListInsertUnlocked(OS_TCBTypeDef *thread);
+void OS_ReadyListRemoveUnlocked(OS_TCBTypeDef *thread);
+void OS_SleepListInsertUnlocked(OS_TCBTypeDef *thread);
+void OS_SleepListRemoveUnlocked(OS_TCBTypeDef *thread);
+void OS_BlockedListInsertUnlocked(OS_TCBTypeDef *thread);
+void OS_BlockedListRemoveUnlocked(OS_TCBTypeDef *thread);
 void OS_ReadyListInsert(OS_TCBTypeDef *thread);
 void OS_ReadyListRemove(OS_TCBTypeDef *thread);
 void OS_SleepListInsert(OS_TCBTypeDef *thread);
@@ -0,0 +1,94 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_TIMER_H
+#define SIMPLERTOS_OS_TIMER_H
+
+#include "mrtos_config.h"
+#include "stdint.h"
+#include "os_semaphore.h"
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * Software timers run their callbacks in a single daemon thread, so a periodic action does not need a thread and a
+ * stack of its own. Active timers are kept in a list ordered by expiry tick, so the SysTick only has to look at the
+ * head of the list no matter how many timers there are. Starting and stopping a timer is a sorted insert or an unlink.
+ * Callbacks share the stack of the daemon and should not block for long, as that delays every other timer.
+ */
+typedef void (*OS_TimerCallbackTypeDef)(void *arg);
+
+typedef struct OS_TimerStruct {
+    OS_TimerCallbackTypeDef callback;
+    void *arg;
+    uint32_t periodTicks;
+    uint32_t autoReload;            // 1 if the timer restarts itself after expiring
+    uint32_t active;
+    uint64_t expiryTick;            // SysTick count the timer expires at, sorts the active list
+    struct OS_TimerStruct *next;
+    struct OS_TimerStruct *prev;
+} OS_TimerTypeDef;
+
+typedef struct {
+    OS_TimerTypeDef *head;          // Active timer that expires first
+    OS_TimerTypeDef *tail;
+    uint32_t overruns;              // Auto reload periods skipped because the daemon could not keep up
+    OS_SemaphoreObjectTypeDef semaphore;    // Wakes the daemon
+} OS_TimerServiceTypeDef;
+
+extern OS_TimerServiceTypeDef osTimerService;
+
+
+/* ----------------------------------------------- Timer functions ------------------------------------------------- */
+/**
+ * @brief: Empties the timer list and creates the daemon thread with TIMER_DAEMON_PRIORITY, call before OS_Launch
+ * @return: 1 if the daemon thread was created
+ */
+uint32_t OS_TimerServiceInit(void);
+
+/**
+ * @brief: Initializes a stopped timer
+ * @param timer: The timer to initialize
+ * @param callback: Function called from the daemon thread when the timer expires
+ * @param arg: Argument passed to the callback
+ * @param periodMillis: Time from starting the timer to it expiring, rounded up to whole SysTicks
+ * @param autoReload: 1 to restart the timer every time it expires, 0 for a one-shot timer
+ */
+void OS_TimerCreate(OS_TimerTypeDef *timer, OS_TimerCallbackTypeDef callback, void *arg, uint32_t periodMillis,
+                    uint32_t autoReload);
+
+/**
+ * @brief: Starts the timer, does nothing if it is already running. Can be called from ISRs.
+ */
+void OS_TimerStart(OS_TimerTypeDef *timer);
+
+/**
+ * @brief: Stops the timer, the callback is not called unless the timer is started again. Can be called from ISRs.
+ */
+void OS_TimerStop(OS_TimerTypeDef *timer);
+
+/**
+ * @brief: Restarts the period of the timer from the current SysTick, starts the timer if it was stopped.
+ *         Can be called from ISRs.
+ */
+void OS_TimerReset(OS_TimerTypeDef *timer);
+
+/**
+ * @brief: Changes the period and restarts the timer from the current SysTick. Can be called from ISRs.
+ * @param periodMillis: The new period, rounded up to whole SysTicks
+ */
+void OS_TimerChangePeriod(OS_TimerTypeDef *timer, uint32_t periodMillis);
+
+/**
+ * @brief: Called by the SysTick handler, wakes the daemon if the first timer has expired. Constant time.
+ * @param tickCount: The current SysTick count
+ */
+void OS_TimerSysTick(uint64_t tickCount);
+
+/**
+ * @brief: Calls the callbacks of every expired timer and restarts the auto reload ones, used by the daemon thread
+ * @return: The amount of callbacks that were called
+ */
+uint32_t OS_TimerRunExpired(void);
+
+#endif //SIMPLERTOS_OS_TIMER_H
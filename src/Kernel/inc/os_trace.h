@@ -0,0 +1,72 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_OS_TRACE_H
+#define SIMPLERTOS_OS_TRACE_H
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "stdint.h"
+
+
+/* --------------------------------------- Type definitions and structures --------------------------------------- */
+/*
+ * Kernel events are recorded into a RAM ring that always holds the newest TRACE_BUFFER_RECORDS events. The ring
+ * can be dumped with a debugger (the osTraceBuffer symbol, including its header) and converted to a Chrome/Perfetto
+ * timeline with tools/trace_decode.py. Keep the layout in sync with the decoder.
+ */
+#define TRACE_MAGIC 0x45435254      // "TRCE" in little endian
+
+typedef enum {
+    TRACE_EVENT_SWITCH = 1,         // Thread switched in, object is the thread that was switched out
+    TRACE_EVENT_SYSTICK = 2,
+    TRACE_EVENT_WAKE = 3,           // Sleep of the thread expired
+    TRACE_EVENT_WAIT = 4,           // Semaphore acquired without blocking
+    TRACE_EVENT_BLOCK = 5,          // Thread blocked on the semaphore
+    TRACE_EVENT_SIGNAL = 6,
+    TRACE_EVENT_USER = 7            // Free for the application, object is any 32-bit value
+} OS_TraceEventTypeDef;
+
+typedef struct {
+    uint32_t timestamp;             // BSP_GetTimestamp at the time of the event
+    uint32_t object;                // Address of the kernel object the event concerns
+    uint8_t event;
+    uint8_t threadId;               // Id of the thread the event concerns, OS_IDLE_THREAD_ID for the idle thread
+    uint16_t reserved;
+} OS_TraceRecordTypeDef;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t recordSize;
+    uint32_t capacity;
+    uint32_t writeCount;            // Total amount of records ever written, the oldest one is overwritten first
+    OS_TraceRecordTypeDef records[TRACE_BUFFER_RECORDS];
+} OS_TraceBufferTypeDef;
+
+
+/* ------------------------------------------------ Trace recording ------------------------------------------------ */
+#if TRACE_ENABLED
+#define OS_TRACE(event, thread, object) OS_TraceRecord((event), (thread)->id, (uint32_t)(uintptr_t)(object))
+#else
+#define OS_TRACE(event, thread, object) ((void)0)
+#endif
+
+#if TRACE_ENABLED
+extern OS_TraceBufferTypeDef osTraceBuffer;
+
+/**
+ * @brief: Appends a record to the trace ring. Use through OS_TRACE so that the call compiles out when disabled.
+ * @param event: One of OS_TraceEventTypeDef
+ * @param threadId: Id of the thread the event concerns
+ * @param object: Address of the kernel object, or any value for user events
+ */
+void OS_TraceRecord(uint8_t event, uint8_t threadId, uint32_t object);
+
+/**
+ * @brief: Empties the trace ring
+ */
+void OS_TraceReset(void);
+#endif
+
+#endif //SIMPLERTOS_OS_TRACE_H
@@ -14,14 +14,42 @@ void EnableInterrupts(void);
 void DisableInterrupts(void);
 
 /**
- * @brief: Enters a critical section (disables interrupts), written in assembly
- * @return: The value of PRIMASK register before disabling interrupts
+ * @brief: Reads a free running high resolution counter used for run time accounting and profiling. The DWT cycle
+ *         counter where there is one, the low half of OS_GetTimeCycles otherwise.
+ * @return: The counter value, allowed to roll over
+ */
+uint32_t BSP_GetTimestamp(void);
+
+/**
+ * @brief: Reads how many core clock cycles of the current SysTick period have elapsed (e.g. LOAD - VAL of SysTick)
+ * @return: Cycles since the SysTick timer last wrapped, less than OS_CYCLES_PER_TICK
+ */
+uint32_t BSP_GetTickTimerElapsed(void);
+
+/**
+ * @brief: Tells if the SysTick timer has wrapped but the interrupt has not been serviced yet (e.g. ICSR PENDSTSET)
+ * @return: 1 if the SysTick interrupt is pending
+ */
+uint32_t BSP_IsTickPending(void);
+
+/**
+ * @brief: Reads the priority of the exception that is currently executing. BSP_HardwareInit must configure PendSV,
+ *         SysTick and every interrupt that calls the kernel at MAX_SYSCALL_INTERRUPT_PRIORITY or numerically above.
+ * @return: The priority in the same units as BASEPRI (already shifted), 0xFF when called from thread mode
+ */
+uint32_t BSP_GetActiveInterruptPriority(void);
+
+/**
+ * @brief: Enters a critical section by raising BASEPRI to MAX_SYSCALL_INTERRUPT_PRIORITY, written in assembly.
+ *         Interrupts above the threshold keep running.
+ * @return: The value of BASEPRI register before masking interrupts
  */
 uint32_t OS_CriticalEnter(void);
 
 /**
- * @brief: Exits a critical section (enables interrupts), written in assembly
- * @param priority: The priority level that the PRIMASK register should be set to
+ * @brief: Exits a critical section by restoring BASEPRI, written in assembly. Interrupts are only unmasked again when
+ *         the outermost critical section exits.
+ * @param priority: The value that the BASEPRI register should be set to
  */
 void OS_CriticalExit(uint32_t prio);
 
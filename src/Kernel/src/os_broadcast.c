@@ -0,0 +1,107 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "os_broadcast.h"
+#include "string.h"
+#include "bsp.h"
+#include "os_critical.h"
+
+
+/* ---------------------------------------- Private function declarations ----------------------------------------- */
+/**
+ * @brief: Copies elements from the ring to the destination, rolling over the end of the ring if needed
+ * @param startIndex: Ring index of the first element to copy
+ */
+static void copyFromRing(OS_BroadcastTypeDef *channel, uint8_t *castDestPtr, uint32_t startIndex, uint32_t dataSize);
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+void OS_BroadcastInit(OS_BroadcastTypeDef *channel, void *dataPtr, uint32_t elements, uint32_t dataSizeBytes) {
+    channel->dataPtr = dataPtr;
+    channel->elements = elements;
+    channel->dataSizeBytes = dataSizeBytes;
+    channel->writeCount = 0;
+    channel->writeIndex = 0;
+}
+
+void OS_BroadcastSubscribe(OS_BroadcastTypeDef *channel, OS_BroadcastReaderTypeDef *reader) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    reader->channel = channel;
+    reader->readCount = channel->writeCount;
+    reader->missed = 0;
+    reader->lastReadSize = 0;
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_BroadcastWrite(OS_BroadcastTypeDef *channel, void *dataPtr, uint32_t dataSize) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+
+    uint8_t *castSrcPtr = dataPtr;
+    // Only the newest elements can fit the ring, skip the ones that would be overwritten by this same write
+    if (dataSize > channel->elements) {
+        uint32_t skipped = dataSize - channel->elements;
+        castSrcPtr += skipped * channel->dataSizeBytes;
+        channel->writeCount += skipped;
+        channel->writeIndex = (channel->writeIndex + skipped) % channel->elements;
+        dataSize = channel->elements;
+    }
+
+    // Cast to byte ptr so that pointer arithmetic can be done
+    uint8_t *castDestPtr = channel->dataPtr;
+    uint32_t writeIndex = channel->writeIndex;
+
+    // If we need to roll over and write in two parts
+    if (dataSize > (channel->elements - writeIndex)) {
+        uint32_t firstWriteSize = channel->elements - writeIndex;
+        memcpy(castDestPtr+(writeIndex*channel->dataSizeBytes), castSrcPtr, firstWriteSize*channel->dataSizeBytes);
+        memcpy(castDestPtr, castSrcPtr+(firstWriteSize*channel->dataSizeBytes), (dataSize-firstWriteSize)*channel->dataSizeBytes);
+    } else {
+        memcpy(castDestPtr+(writeIndex*channel->dataSizeBytes), castSrcPtr, dataSize*channel->dataSizeBytes);
+    }
+
+    // Readers derive their position from the write count, so publishing does not touch any reader
+    channel->writeCount += dataSize;
+    channel->writeIndex = (writeIndex + dataSize) % channel->elements;
+
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_BroadcastRead(OS_BroadcastReaderTypeDef *reader, void *dataPtr, uint32_t dataSize) {
+    OS_BroadcastTypeDef *channel = reader->channel;
+    uint32_t pri = OS_CRITICAL_ENTER();
+
+    // Unsigned arithmetic keeps this correct when writeCount rolls over
+    uint32_t unread = channel->writeCount - reader->readCount;
+
+    // If the writer has lapped this reader, skip to the oldest element still in the ring
+    if (unread > channel->elements) {
+        reader->missed += unread - channel->elements;
+        reader->readCount = channel->writeCount - channel->elements;
+        unread = channel->elements;
+    }
+
+    dataSize = dataSize > unread ? unread : dataSize;
+    reader->lastReadSize = dataSize;
+
+    // The oldest unread element is 'unread' elements behind the write index
+    uint32_t readIndex = (channel->writeIndex + channel->elements - unread) % channel->elements;
+    copyFromRing(channel, dataPtr, readIndex, dataSize);
+    reader->readCount += dataSize;
+
+    OS_CRITICAL_EXIT(pri);
+}
+
+static void copyFromRing(OS_BroadcastTypeDef *channel, uint8_t *castDestPtr, uint32_t startIndex, uint32_t dataSize) {
+    uint8_t *castSrcPtr = channel->dataPtr;
+
+    // If we need to roll over and read in two parts
+    if (dataSize > (channel->elements - startIndex)) {
+        uint32_t firstReadSize = channel->elements - startIndex;
+        memcpy(castDestPtr, castSrcPtr+(startIndex*channel->dataSizeBytes), firstReadSize*channel->dataSizeBytes);
+        memcpy(castDestPtr+(firstReadSize*channel->dataSizeBytes), castSrcPtr, (dataSize-firstReadSize)*channel->dataSizeBytes);
+    } else {
+        memcpy(castDestPtr, castSrcPtr+(startIndex*channel->dataSizeBytes), dataSize*channel->dataSizeBytes);
+    }
+}
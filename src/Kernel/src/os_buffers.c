@@ -8,12 +8,22 @@
 #include "os_core.h"
 #include "string.h"
 #include "bsp.h"
+#include "os_select.h"
+#include "os_threads.h"
+#include "os_critical.h"
 
 
 /* ---------------------------------------- Private function declarations ----------------------------------------- */
 static void incrementPointer(OS_BufferTypeDef *bufferObject, uint32_t elements);
 static uint32_t getFreeElements(OS_BufferTypeDef *bufferObject);
 
+/**
+ * @brief: Copies the data to the buffer and wakes a thread waiting for it in OS_WaitAny, must be called inside a
+ *         critical section
+ * @return: 1 if the woken thread has higher priority than the currently running thread
+ */
+static uint32_t writeToBuffer(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t dataSize);
+
 
 static void incrementPointer(OS_BufferTypeDef *bufferObject, uint32_t elements) {
 
@@ -37,12 +47,33 @@ void OS_BufferInit(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t eleme
     bufferObject->writeIndex = 0;
     bufferObject->readIndex = 0;
     bufferObject->spaceRemaining = elements;
+    bufferObject->missed = 0;
+    bufferObject->lastReadSize = 0;
 }
 
 void OS_BufferWrite(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t dataSize) {
     OS_Wait(&bufferObject->semaphore);
-    uint32_t pri = OS_CriticalEnter();
+    uint32_t pri = OS_CRITICAL_ENTER();
+    uint32_t shouldSuspend = writeToBuffer(bufferObject, dataPtr, dataSize);
+    OS_CRITICAL_EXIT(pri);
+    OS_Signal(&bufferObject->semaphore);
+
+    if (shouldSuspend) {
+        OS_Suspend(OS_SUSPEND_UNBLOCK);
+    }
+}
 
+void OS_BufferWriteFromISR(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t dataSize) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    // The data is only ever touched inside critical sections, so the ISR does not need the mutex to write
+    uint32_t pri = OS_CRITICAL_ENTER();
+    if (writeToBuffer(bufferObject, dataPtr, dataSize)) {
+        OS_RequestRescheduleFromISR();
+    }
+    OS_CRITICAL_EXIT(pri);
+}
+
+static uint32_t writeToBuffer(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t dataSize) {
     dataSize = dataSize > bufferObject->elements ? bufferObject->elements : dataSize;
 
     // If we have to overwrite unread data
@@ -84,13 +115,14 @@ void OS_BufferWrite(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t data
         bufferObject->readIndex = bufferObject->writeIndex;
     }
 
-    OS_CriticalExit(pri);
-    OS_Signal(&bufferObject->semaphore);
+    // Buffer has unread data now, wake up a thread waiting for it in OS_WaitAny
+    OS_TCBTypeDef *waiter = OS_SelectWakeWaiter(bufferObject);
+    return waiter != NULL && waiter->priority < runPtr->priority;
 }
 
 void OS_BufferRead(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t dataSize) {
     OS_Wait(&bufferObject->semaphore);
-    uint32_t pri = OS_CriticalEnter();
+    uint32_t pri = OS_CRITICAL_ENTER();
 
     uint32_t unread = (bufferObject->elements - bufferObject->spaceRemaining);
     dataSize = dataSize > unread ? unread : dataSize;
@@ -111,9 +143,9 @@ void OS_BufferRead(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t dataS
         bufferObject->readIndex += secondReadSize;
         bufferObject->spaceRemaining += (firstReadSize+secondReadSize);
     } else {
-        memcpy(castDestPtr+(bufferObject->readIndex*bufferObject->dataSizeBytes), castSrcPtr, dataSize*bufferObject->dataSizeBytes);
+        memcpy(castDestPtr, castSrcPtr+(bufferObject->readIndex*bufferObject->dataSizeBytes), dataSize*bufferObject->dataSizeBytes);
         // If we read until the last index
-        if (dataSize == (bufferObject->elements - bufferObject->writeIndex)) {
+        if (dataSize == (bufferObject->elements - bufferObject->readIndex)) {
             bufferObject->readIndex = 0;
         } else {
             bufferObject->readIndex += dataSize;
@@ -121,6 +153,6 @@ void OS_BufferRead(OS_BufferTypeDef *bufferObject, void *dataPtr, uint32_t dataS
         bufferObject->spaceRemaining += (dataSize);
     }
 
-    OS_CriticalExit(pri);
+    OS_CRITICAL_EXIT(pri);
     OS_Signal(&bufferObject->semaphore);
 }
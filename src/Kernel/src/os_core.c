@@ -7,10 +7,17 @@
 #include "os_core.h"
 #include "stddef.h"
 #include "os_threads.h"
+#include "os_trace.h"
+#include "os_critical.h"
+#include "os_scheduling.h"
+#include "os_timer.h"
+#include "os_table.h"
+#include "os_server.h"
+#include "os_select.h"
 
 
 /* --------------------------------------------- Private variables ----------------------------------------------- */
-static uint64_t sysTickCount = 0;  // The amount of SysTicks since last scheduler execution
+static volatile uint64_t sysTickCount = 0;  // The amount of SysTicks since startup, only written by the SysTick
 
 
 /* ---------------------------------------- Private function declarations ----------------------------------------- */
@@ -27,6 +34,9 @@ static uint32_t OS_SysTickCallback(void);
  */
 void OS_ResetState() {
     OS_ResetThreads();
+    OS_ResetServers();
+    OS_ResetSelect();
+    OS_ResetTables();
 }
 
 
@@ -50,7 +60,62 @@ void OS_Launch(void) {
 
 /* ----------------------------------------- SysTick handler and callback ----------------------------------------- */
 uint64_t OS_GetSysTickCount(void) {
-    return sysTickCount;
+    uint64_t count;
+    do {
+        count = sysTickCount;
+    } while (count != sysTickCount);
+
+    return count;
+}
+
+uint64_t OS_GetTimeCycles(void) {
+    uint64_t count;
+    uint32_t elapsed;
+
+    do {
+        count = sysTickCount;
+        elapsed = BSP_GetTickTimerElapsed();
+        // The timer can have wrapped without the SysTick having run yet, when it is masked or preempted. Pending is
+        // read after the elapsed cycles, so if it is clear the first read was from before the wrap. If it is set, the
+        // wrap happened before the read of the flag, and a second read is guaranteed to be from after it.
+        if (BSP_IsTickPending()) {
+            elapsed = OS_CYCLES_PER_TICK + BSP_GetTickTimerElapsed();
+        }
+        // Retry if the SysTick ran in between, the count and the timer must be from the same tick
+    } while (count != sysTickCount);
+
+    return count * OS_CYCLES_PER_TICK + elapsed;
+}
+
+uint64_t OS_GetTimeNs(void) {
+    return OS_CyclesToNs(OS_GetTimeCycles());
+}
+
+uint64_t OS_CyclesToNs(uint64_t cycles) {
+    return cycles * 1000u / SYSCLOCK_FREQUENCY;
+}
+
+uint64_t OS_NsToCycles(uint64_t nanos) {
+    return nanos * SYSCLOCK_FREQUENCY / 1000u;
+}
+
+uint64_t OS_CyclesToMicros(uint64_t cycles) {
+    return cycles / SYSCLOCK_FREQUENCY;
+}
+
+uint32_t OS_MillisToTicks(uint32_t millis) {
+    // Rounded up without adding to millis first, which would overflow for periods near UINT32_MAX
+    uint32_t ticks = millis / SYS_TICK_PERIOD_MILLIS + (millis % SYS_TICK_PERIOD_MILLIS != 0);
+    return ticks == 0 ? 1 : ticks;
+}
+
+uint64_t OS_WakeTickFromMillis(uint32_t millis) {
+    if (millis == OS_WAIT_FOREVER) {
+        return UINT64_MAX;
+    }
+
+    // The next SysTick is the earliest wake up
+    return sysTickCount + OS_MillisToTicks(millis);
 }
 
 /***
@@ -61,72 +126,94 @@ void SysTick_Handler() {
     static uint32_t currentTickCount = 0;  // The amount of SysTicks since last scheduler execution
     currentTickCount++;
     sysTickCount++;
+    OS_TRACE(TRACE_EVENT_SYSTICK, runPtr, 0);
 
     uint32_t shouldRunScheduler = 0;
     shouldRunScheduler = OS_SysTickCallback();
     // Since the time slice for each thread might be longer than the SysTick period, check if enough SysTicks have
     // been observed since the last time scheduler was ran
     if (currentTickCount * SYS_TICK_PERIOD_MILLIS >= THREAD_TIME_SLICE_MILLIS || shouldRunScheduler) {
-        BSP_TriggerPendSV();
+        OS_RequestRescheduleFromISR();
         currentTickCount = 0;
     }
+    // The timer service wakes its daemon with a FromISR signal, so every reason to switch shares a single PendSV
+    OS_YieldFromISR();
 }
 
 static uint32_t OS_SysTickCallback() {
-    uint32_t priority = OS_CriticalEnter();
     uint32_t shouldRunScheduler = 0;
 
-    // Iterate through the complete thread list and decrement all sleep counters by the period of the SysTick
-    OS_TCBTypeDef *tmpPtr = sleepHeadPtr;
-    OS_TCBTypeDef *tmpPtr2;
-    while (tmpPtr != NULL) {
-        // Because tmpPtr->next might point to a ready thread at the end of loop if tmpPtr stops sleeping
-        tmpPtr2 = tmpPtr->next;
-        // If value would go to zero (or roll over), make thread ready
-        if (tmpPtr->sleep <= SYS_TICK_PERIOD_MILLIS) {
-            OS_SleepListRemove(tmpPtr);
-            OS_ReadyListInsert(tmpPtr);
-            tmpPtr->sleep = 0;
-            // After scheduler has been flagged to run no reason the check for it anymore
-            if (!shouldRunScheduler) {
-                // If new ready to run thread higher priority then runPtr, schedule it to run afterwards
-                if (tmpPtr->priority < runPtr->priority) {
-                    shouldRunScheduler = 1;
-                }
-            }
-        } else {
-            tmpPtr->sleep -= SYS_TICK_PERIOD_MILLIS;
+    // The sleep list is ordered by wake up tick, so only expired threads at the head of it need to be looked at. Each
+    // wake up gets a critical section of its own to keep the interrupt disabled time bounded to one list move.
+    while (1) {
+        uint32_t priority = OS_CRITICAL_ENTER();
+        OS_TCBTypeDef *tmpPtr = sleepHeadPtr;
+        if (tmpPtr == NULL || tmpPtr->wakeTick > sysTickCount) {
+            OS_CRITICAL_EXIT(priority);
+            break;
         }
 
-        tmpPtr = tmpPtr2;
+        OS_SleepListRemoveUnlocked(tmpPtr);
+        OS_ReadyListInsertUnlocked(tmpPtr);
+        tmpPtr->sleep = 0;
+        // Timed out in OS_WaitAny, the result was already set to timeout when it started waiting
+        if (tmpPtr->waitObjects != NULL) {
+            OS_SelectListRemoveUnlocked(tmpPtr);
+            tmpPtr->waitObjects = NULL;
+        }
+        // If new ready to run thread higher priority then runPtr, schedule it to run afterwards
+        if (tmpPtr->priority < runPtr->priority) {
+            shouldRunScheduler = 1;
+        }
+        OS_CRITICAL_EXIT(priority);
+        OS_TRACE(TRACE_EVENT_WAKE, tmpPtr, 0);
+    }
+
+    OS_TimerSysTick(sysTickCount);
+
+    if (OS_TableSysTick()) {
+        shouldRunScheduler = 1;
+    }
+
+    if (OS_ServerSysTick(sysTickCount)) {
+        shouldRunScheduler = 1;
+    }
+
+#if THREAD_BUDGET_ENABLED
+    if (OS_BudgetSysTick(sysTickCount)) {
+        shouldRunScheduler = 1;
     }
+#endif
 
-    // Iterate through the periodic thread list and decrement all period counters
+    // Iterate through the periodic thread list and release the threads whose release time has been reached
     OS_TCBTypeDef **listPtr = getPeriodicListPtr();
-    while (*listPtr != NULL) {
-        // If value would go to zero (or roll over), make thread ready
-        if ((*listPtr)->period <= SYS_TICK_PERIOD_MILLIS) {
-            (*listPtr)->period = (*listPtr)->basePeriod;
+    while (1) {
+        // The list is compacted when a thread is deleted, so each element is handled in a critical section of its own
+        uint32_t priority = OS_CRITICAL_ENTER();
+        OS_TCBTypeDef *thread = *listPtr;
+        if (thread == NULL) {
+            OS_CRITICAL_EXIT(priority);
+            break;
+        }
+
+        // Releases are on an absolute grid of SysTicks, so the execution time of the thread never shifts them
+        if (thread->nextRelease <= sysTickCount) {
+            thread->nextRelease += thread->periodTicks;
 
             // Check to avoid double insertion to ready list, in case thread is still executing (in ready list)
-            if ((*listPtr)->hasFullyRan) {
-                OS_ReadyListInsert((*listPtr));
-                (*listPtr)->hasFullyRan = 0;
-                // After scheduler has been flagged to run no reason the check for it anymore
-                if (!shouldRunScheduler) {
-                    // If new ready to run thread higher priority then runPtr, schedule it to run afterwards
-                    if ((*listPtr)->priority < runPtr->priority) {
-                        shouldRunScheduler = 1;
-                    }
+            if (thread->hasFullyRan) {
+                OS_ReadyListInsertUnlocked(thread);
+                thread->hasFullyRan = 0;
+                // If new ready to run thread higher priority then runPtr, schedule it to run afterwards
+                if (thread->priority < runPtr->priority) {
+                    shouldRunScheduler = 1;
                 }
             }
-        } else {
-            (*listPtr)->period -= SYS_TICK_PERIOD_MILLIS;
         }
+        OS_CRITICAL_EXIT(priority);
 
         listPtr++;
     }
 
-    OS_CriticalExit(priority);
     return shouldRunScheduler;
 }
\ No newline at end of file
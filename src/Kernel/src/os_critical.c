@@ -0,0 +1,112 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "os_critical.h"
+#include "stddef.h"
+#include "string.h"
+
+
+/* ----------------------------------------------- Global variables ----------------------------------------------- */
+OS_CriticalProfileTypeDef osCriticalProfile = { 0 };
+#if SYSCALL_PRIORITY_CHECK_ENABLED && TEST
+uint32_t osSyscallPriorityViolations = 0;
+#endif
+
+
+/* ---------------------------------------- Private function declarations ----------------------------------------- */
+/**
+ * @brief: Finds the statistics of the call site, or takes an unused entry for it
+ * @return: The entry, or NULL if the table is full
+ */
+static OS_CriticalSiteTypeDef *findSite(const char *file, uint32_t line);
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+static OS_CriticalSiteTypeDef *findSite(const char *file, uint32_t line) {
+    // Each call site has a distinct line, and __FILE__ of the same file is normally the same pointer
+    uint32_t index = (line * 0x9E3779B1U >> 16) % CRITICAL_PROFILING_SITES;
+
+    for (uint32_t probes = 0; probes < CRITICAL_PROFILING_SITES; probes++) {
+        OS_CriticalSiteTypeDef *site = &osCriticalProfile.sites[index];
+        if (site->file == NULL) {
+            site->file = file;
+            site->line = line;
+            return site;
+        }
+
+        if (site->line == line && (site->file == file || strcmp(site->file, file) == 0)) {
+            return site;
+        }
+
+        index = (index + 1) % CRITICAL_PROFILING_SITES;
+    }
+
+    return NULL;
+}
+
+uint32_t OS_HistogramBucket(uint32_t value, uint32_t buckets) {
+    uint32_t bucket = 0;
+    while (value != 0 && bucket < buckets - 1) {
+        value >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+uint32_t OS_CriticalProfiledEnter(const char *file, uint32_t line) {
+    uint32_t priority = OS_CriticalEnter();
+
+    if (osCriticalProfile.depth++ == 0) {
+        osCriticalProfile.openFile = file;
+        osCriticalProfile.openLine = line;
+        osCriticalProfile.openTimestamp = BSP_GetTimestamp();
+    }
+
+    if (osCriticalProfile.depth > osCriticalProfile.maxDepth) {
+        osCriticalProfile.maxDepth = osCriticalProfile.depth;
+    }
+
+    return priority;
+}
+
+void OS_CriticalProfiledExit(uint32_t priority) {
+    if (--osCriticalProfile.depth == 0) {
+        // Take the timestamp first, so that the bookkeeping is not counted in the duration
+        uint32_t duration = BSP_GetTimestamp() - osCriticalProfile.openTimestamp;
+        OS_CriticalSiteTypeDef *site = findSite(osCriticalProfile.openFile, osCriticalProfile.openLine);
+
+        if (site != NULL) {
+            site->count++;
+            site->histogram[OS_HistogramBucket(duration, CRITICAL_HISTOGRAM_BUCKETS)]++;
+            if (duration > site->maxDuration) {
+                site->maxDuration = duration;
+            }
+        } else {
+            osCriticalProfile.droppedSections++;
+        }
+    }
+
+    OS_CriticalExit(priority);
+}
+
+const OS_CriticalSiteTypeDef *OS_CriticalGetWorstSite(void) {
+    const OS_CriticalSiteTypeDef *worst = NULL;
+
+    for (uint32_t i = 0; i < CRITICAL_PROFILING_SITES; i++) {
+        const OS_CriticalSiteTypeDef *site = &osCriticalProfile.sites[i];
+        if (site->file != NULL && (worst == NULL || site->maxDuration > worst->maxDuration)) {
+            worst = site;
+        }
+    }
+
+    return worst;
+}
+
+void OS_CriticalProfileReset(void) {
+    uint32_t priority = OS_CriticalEnter();
+    memset(&osCriticalProfile, 0, sizeof(osCriticalProfile));
+    OS_CriticalExit(priority);
+}
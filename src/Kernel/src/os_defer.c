@@ -0,0 +1,109 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "stddef.h"
+#include "os_defer.h"
+#include "os_threads.h"
+#include "os_scheduling.h"
+#include "bsp.h"
+#include "os_critical.h"
+
+// Slots are found by masking the free running indexes
+#if (DEFER_QUEUE_LENGTH & (DEFER_QUEUE_LENGTH - 1)) != 0
+#error "DEFER_QUEUE_LENGTH must be a power of two"
+#endif
+
+
+/* ----------------------------------------------- Global variables ----------------------------------------------- */
+OS_DeferQueueTypeDef osDeferQueue;
+
+
+/* --------------------------------------------- Private variables ----------------------------------------------- */
+static StackElementTypeDef deferWorkerStack[DEFER_WORKER_STACK_SIZE];
+
+
+/* ---------------------------------------- Private function declarations ----------------------------------------- */
+/**
+ * @brief: Thread function of the worker, sleeps on the semaphore until calls are queued
+ */
+static void deferWorker(void *ptr);
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+uint32_t OS_DeferInit(void) {
+    osDeferQueue.head = 0;
+    osDeferQueue.tail = 0;
+    osDeferQueue.dropped = 0;
+    osDeferQueue.highWater = 0;
+    for (uint32_t i = 0; i < DEFER_QUEUE_LENGTH; i++) {
+        osDeferQueue.calls[i].ready = 0;
+    }
+    OS_InitSemaphore(&osDeferQueue.semaphore, SEMAPHORE_FLAG);
+
+    return OS_CreateThread(&deferWorker, deferWorkerStack, DEFER_WORKER_STACK_SIZE, DEFER_WORKER_PRIORITY,
+                           "defer worker") != NULL;
+}
+
+uint32_t OS_DeferCall(OS_DeferredFunctionTypeDef function, void *arg) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+
+    // Only the reservation of the slot is done in a critical section, nested ISRs each get a slot of their own
+    uint32_t pri = OS_CRITICAL_ENTER();
+    uint32_t queued = osDeferQueue.tail - osDeferQueue.head;
+    if (queued == DEFER_QUEUE_LENGTH) {
+        osDeferQueue.dropped++;
+        OS_CRITICAL_EXIT(pri);
+        return 0;
+    }
+    uint32_t slot = osDeferQueue.tail & (DEFER_QUEUE_LENGTH - 1);
+    osDeferQueue.tail++;
+    if (queued + 1 > osDeferQueue.highWater) {
+        osDeferQueue.highWater = queued + 1;
+    }
+    OS_CRITICAL_EXIT(pri);
+
+    OS_DeferredCallTypeDef *call = &osDeferQueue.calls[slot];
+    call->function = function;
+    call->arg = arg;
+    call->ready = 1;
+
+    OS_SignalFromISR(&osDeferQueue.semaphore);
+    // An ISR lets the worker run when it calls OS_YieldFromISR on the way out, a thread has to yield by itself
+    if (BSP_GetActiveInterruptPriority() == 0xFF) {
+        OS_YieldIfPending();
+    }
+    return 1;
+}
+
+uint32_t OS_DeferRunPending(void) {
+    uint32_t ran = 0;
+
+    while (osDeferQueue.head != osDeferQueue.tail) {
+        OS_DeferredCallTypeDef *call = &osDeferQueue.calls[osDeferQueue.head & (DEFER_QUEUE_LENGTH - 1)];
+        // Reserved by an ISR that has not finished filling it, calls after it have to wait to keep the order
+        if (!call->ready) {
+            break;
+        }
+
+        OS_DeferredFunctionTypeDef function = call->function;
+        void *arg = call->arg;
+        call->ready = 0;
+        // Free the slot before the call, so that the function can defer another call
+        osDeferQueue.head++;
+
+        function(arg);
+        ran++;
+    }
+
+    return ran;
+}
+
+static void deferWorker(void *ptr) {
+    (void)ptr;
+    while (1) {
+        OS_Wait(&osDeferQueue.semaphore);
+        OS_DeferRunPending();
+    }
+}
@@ -0,0 +1,74 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "assert.h"
+#include "stddef.h"
+#include "os_double_buffer.h"
+#include "bsp.h"
+#include "os_critical.h"
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+void OS_DoubleBufferInit(OS_DoubleBufferTypeDef *doubleBuffer, void *dataPtr, uint32_t halfSizeBytes) {
+    // Both halves have to be aligned for the DMA, use OS_DOUBLE_BUFFER_DECLARE for the storage
+    assert(((uintptr_t)dataPtr % DOUBLE_BUFFER_ALIGNMENT) == 0);
+    assert((halfSizeBytes % DOUBLE_BUFFER_ALIGNMENT) == 0);
+
+    OS_InitSemaphore(&doubleBuffer->semaphore, SEMAPHORE_FLAG);
+    doubleBuffer->dataPtr = dataPtr;
+    doubleBuffer->halfSizeBytes = halfSizeBytes;
+    doubleBuffer->dmaHalf = 0;
+    doubleBuffer->readyHalf = 1;
+    doubleBuffer->pending = 0;
+    doubleBuffer->consumerOwns = 0;
+    doubleBuffer->overruns = 0;
+}
+
+void *OS_DoubleBufferDMATarget(OS_DoubleBufferTypeDef *doubleBuffer) {
+    return doubleBuffer->dataPtr + (doubleBuffer->dmaHalf*doubleBuffer->halfSizeBytes);
+}
+
+void *OS_DoubleBufferSwap(OS_DoubleBufferTypeDef *doubleBuffer) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    uint32_t pri = OS_CRITICAL_ENTER();
+    uint32_t shouldSignal = 0;
+
+    // The other half is either still being processed or was never picked up, so there is nowhere to swap to
+    if (doubleBuffer->consumerOwns || doubleBuffer->pending) {
+        doubleBuffer->overruns++;
+    } else {
+        doubleBuffer->readyHalf = doubleBuffer->dmaHalf;
+        doubleBuffer->dmaHalf ^= 1;
+        doubleBuffer->pending = 1;
+        shouldSignal = 1;
+    }
+
+    void *next = OS_DoubleBufferDMATarget(doubleBuffer);
+    OS_CRITICAL_EXIT(pri);
+
+    if (shouldSignal) {
+        OS_SignalFromISR(&doubleBuffer->semaphore);
+    }
+
+    return next;
+}
+
+void *OS_DoubleBufferAcquire(OS_DoubleBufferTypeDef *doubleBuffer) {
+    OS_Wait(&doubleBuffer->semaphore);
+
+    uint32_t pri = OS_CRITICAL_ENTER();
+    doubleBuffer->pending = 0;
+    doubleBuffer->consumerOwns = 1;
+    void *half = doubleBuffer->dataPtr + (doubleBuffer->readyHalf*doubleBuffer->halfSizeBytes);
+    OS_CRITICAL_EXIT(pri);
+
+    return half;
+}
+
+void OS_DoubleBufferRelease(OS_DoubleBufferTypeDef *doubleBuffer) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    doubleBuffer->consumerOwns = 0;
+    OS_CRITICAL_EXIT(pri);
+}
@@ -0,0 +1,387 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "assert.h"
+#include "stddef.h"
+#include "string.h"
+#include "os_heap.h"
+#include "bsp.h"
+#include "os_critical.h"
+
+
+/* ---------------------------------------------- Private definitions --------------------------------------------- */
+#define BLOCK_FREE_BIT ((uintptr_t)0x1)
+#define BLOCK_PREV_FREE_BIT ((uintptr_t)0x2)
+#define BLOCK_FLAG_BITS (BLOCK_FREE_BIT | BLOCK_PREV_FREE_BIT)
+
+// Allocated blocks only carry the physical links and the size, the free list links overlap the payload
+#define BLOCK_HEADER_SIZE (offsetof(OS_HeapBlockTypeDef, nextFree))
+#define BLOCK_SIZE_MIN (sizeof(OS_HeapBlockTypeDef) - BLOCK_HEADER_SIZE)
+#define BLOCK_SIZE_MAX (((uintptr_t)1 << HEAP_FL_INDEX_MAX) - HEAP_ALIGN_SIZE)
+#define SMALL_BLOCK_SIZE ((uintptr_t)1 << HEAP_FL_INDEX_SHIFT)
+
+
+/* ---------------------------------------- Private function declarations ----------------------------------------- */
+/**
+ * @brief: Index of the most significant set bit, -1 if none is set
+ */
+static int32_t findLastSet(uint32_t word);
+
+/**
+ * @brief: Index of the least significant set bit, -1 if none is set
+ */
+static int32_t findFirstSet(uint32_t word);
+
+/**
+ * @brief: Maps a block size to the free list that holds blocks of that size
+ */
+static void mappingInsert(uintptr_t size, uint32_t *fl, uint32_t *sl);
+
+/**
+ * @brief: Maps a requested size to the first free list whose every block is large enough for it
+ */
+static void mappingSearch(uintptr_t size, uint32_t *fl, uint32_t *sl);
+
+static OS_HeapBlockTypeDef *searchSuitableBlock(OS_HeapTypeDef *heap, uint32_t *fl, uint32_t *sl);
+static void insertFreeBlock(OS_HeapTypeDef *heap, OS_HeapBlockTypeDef *block);
+static void removeFreeBlock(OS_HeapTypeDef *heap, OS_HeapBlockTypeDef *block);
+
+static uintptr_t blockSize(const OS_HeapBlockTypeDef *block);
+static OS_HeapBlockTypeDef *blockNext(const OS_HeapBlockTypeDef *block);
+static void blockSetSize(OS_HeapBlockTypeDef *block, uintptr_t size);
+static void blockMarkFree(OS_HeapBlockTypeDef *block);
+static void blockMarkUsed(OS_HeapBlockTypeDef *block);
+
+
+/* ------------------------------------------------- Bit scanning ------------------------------------------------- */
+#if defined(__GNUC__)
+static int32_t findLastSet(uint32_t word) {
+    return word ? 31 - __builtin_clz(word) : -1;
+}
+#elif defined(__ICCARM__)
+#include <intrinsics.h>
+static int32_t findLastSet(uint32_t word) {
+    return 31 - (int32_t)__CLZ(word);
+}
+#else
+static int32_t findLastSet(uint32_t word) {
+    int32_t bit = -1;
+    while (word) {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+}
+#endif
+
+static int32_t findFirstSet(uint32_t word) {
+    return findLastSet(word & (~word + 1));
+}
+
+
+/* ---------------------------------------------- Block manipulation ---------------------------------------------- */
+static uintptr_t blockSize(const OS_HeapBlockTypeDef *block) {
+    return block->size & ~BLOCK_FLAG_BITS;
+}
+
+static OS_HeapBlockTypeDef *blockNext(const OS_HeapBlockTypeDef *block) {
+    return (OS_HeapBlockTypeDef *)((uint8_t *)block + BLOCK_HEADER_SIZE + blockSize(block));
+}
+
+static void blockSetSize(OS_HeapBlockTypeDef *block, uintptr_t size) {
+    block->size = size | (block->size & BLOCK_FLAG_BITS);
+}
+
+static void blockMarkFree(OS_HeapBlockTypeDef *block) {
+    OS_HeapBlockTypeDef *next = blockNext(block);
+    block->size |= BLOCK_FREE_BIT;
+    next->size |= BLOCK_PREV_FREE_BIT;
+    next->prevPhys = block;
+}
+
+static void blockMarkUsed(OS_HeapBlockTypeDef *block) {
+    block->size &= ~BLOCK_FREE_BIT;
+    blockNext(block)->size &= ~BLOCK_PREV_FREE_BIT;
+}
+
+
+/* ---------------------------------------------- Free list handling ---------------------------------------------- */
+static void mappingInsert(uintptr_t size, uint32_t *fl, uint32_t *sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        // Small blocks are split linearly into the second level lists of the first list
+        *fl = 0;
+        *sl = (uint32_t)(size / (SMALL_BLOCK_SIZE / HEAP_SL_INDEX_COUNT));
+    } else {
+        int32_t bit = findLastSet((uint32_t)size);
+        *sl = (uint32_t)(size >> (bit - HEAP_SL_INDEX_COUNT_LOG2)) ^ HEAP_SL_INDEX_COUNT;
+        *fl = (uint32_t)(bit - (HEAP_FL_INDEX_SHIFT - 1));
+    }
+}
+
+static void mappingSearch(uintptr_t size, uint32_t *fl, uint32_t *sl) {
+    // Round up to the next list, so that any block in the found list is large enough without searching the list
+    if (size >= SMALL_BLOCK_SIZE) {
+        size += ((uintptr_t)1 << (findLastSet((uint32_t)size) - HEAP_SL_INDEX_COUNT_LOG2)) - 1;
+    }
+    mappingInsert(size, fl, sl);
+}
+
+static OS_HeapBlockTypeDef *searchSuitableBlock(OS_HeapTypeDef *heap, uint32_t *fl, uint32_t *sl) {
+    // First look for a non-empty list in the same first level, at or above the second level index
+    uint32_t slMap = (*sl < 32) ? heap->slBitmap[*fl] & (~0U << *sl) : 0;
+    if (!slMap) {
+        // Otherwise take the smallest list from any larger first level
+        uint32_t flMap = (*fl + 1 < 32) ? heap->flBitmap & (~0U << (*fl + 1)) : 0;
+        if (!flMap) {
+            return NULL;
+        }
+
+        *fl = (uint32_t)findFirstSet(flMap);
+        slMap = heap->slBitmap[*fl];
+    }
+
+    *sl = (uint32_t)findFirstSet(slMap);
+    return heap->freeLists[*fl][*sl];
+}
+
+static void insertFreeBlock(OS_HeapTypeDef *heap, OS_HeapBlockTypeDef *block) {
+    uint32_t fl;
+    uint32_t sl;
+    mappingInsert(blockSize(block), &fl, &sl);
+
+    OS_HeapBlockTypeDef *head = heap->freeLists[fl][sl];
+    block->nextFree = head;
+    block->prevFree = NULL;
+    if (head != NULL) {
+        head->prevFree = block;
+    }
+
+    heap->freeLists[fl][sl] = block;
+    heap->flBitmap |= (1U << fl);
+    heap->slBitmap[fl] |= (1U << sl);
+}
+
+static void removeFreeBlock(OS_HeapTypeDef *heap, OS_HeapBlockTypeDef *block) {
+    uint32_t fl;
+    uint32_t sl;
+    mappingInsert(blockSize(block), &fl, &sl);
+
+    if (block->nextFree != NULL) {
+        block->nextFree->prevFree = block->prevFree;
+    }
+
+    if (block->prevFree != NULL) {
+        block->prevFree->nextFree = block->nextFree;
+    } else {
+        // Block was the head of the list, clear the bitmaps if the list became empty
+        heap->freeLists[fl][sl] = block->nextFree;
+        if (block->nextFree == NULL) {
+            heap->slBitmap[fl] &= ~(1U << sl);
+            if (heap->slBitmap[fl] == 0) {
+                heap->flBitmap &= ~(1U << fl);
+            }
+        }
+    }
+}
+
+
+/* ----------------------------------------------- Heap functions ------------------------------------------------- */
+void OS_HeapInit(OS_HeapTypeDef *heap, void *memPtr, uint32_t sizeBytes) {
+    memset(heap, 0, sizeof(OS_HeapTypeDef));
+
+    // Align the start of the memory, and leave room for the zero sized sentinel header at the end
+    uintptr_t start = ((uintptr_t)memPtr + HEAP_ALIGN_SIZE - 1) & ~((uintptr_t)HEAP_ALIGN_SIZE - 1);
+    uintptr_t end = ((uintptr_t)memPtr + sizeBytes) & ~((uintptr_t)HEAP_ALIGN_SIZE - 1);
+    assert(end > start + 2*BLOCK_HEADER_SIZE + BLOCK_SIZE_MIN);
+
+    uintptr_t size = end - start - 2*BLOCK_HEADER_SIZE;
+    assert(size <= BLOCK_SIZE_MAX);
+
+    OS_HeapBlockTypeDef *block = (OS_HeapBlockTypeDef *)start;
+    block->prevPhys = NULL;
+    block->size = size;
+
+    // The sentinel is a permanently allocated block, so that the last real block always has a next block
+    OS_HeapBlockTypeDef *sentinel = blockNext(block);
+    sentinel->size = 0;
+
+    blockMarkFree(block);
+    insertFreeBlock(heap, block);
+
+    heap->firstBlock = block;
+    heap->totalBytes = (uint32_t)(size + BLOCK_HEADER_SIZE);
+}
+
+void *OS_HeapAlloc(OS_HeapTypeDef *heap, uint32_t sizeBytes) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    if (sizeBytes == 0 || sizeBytes > BLOCK_SIZE_MAX) {
+        uint32_t pri = OS_CRITICAL_ENTER();
+        heap->failed++;
+        OS_CRITICAL_EXIT(pri);
+        return NULL;
+    }
+
+    uintptr_t size = ((uintptr_t)sizeBytes + HEAP_ALIGN_SIZE - 1) & ~((uintptr_t)HEAP_ALIGN_SIZE - 1);
+    size = size < BLOCK_SIZE_MIN ? BLOCK_SIZE_MIN : size;
+
+    uint32_t fl;
+    uint32_t sl;
+    mappingSearch(size, &fl, &sl);
+
+    uint32_t pri = OS_CRITICAL_ENTER();
+
+    OS_HeapBlockTypeDef *block = (fl < HEAP_FL_INDEX_COUNT) ? searchSuitableBlock(heap, &fl, &sl) : NULL;
+    if (block == NULL) {
+        heap->failed++;
+        OS_CRITICAL_EXIT(pri);
+        return NULL;
+    }
+
+    removeFreeBlock(heap, block);
+
+    // Split off the tail of the block if it can hold a block of its own
+    if (blockSize(block) >= size + BLOCK_HEADER_SIZE + BLOCK_SIZE_MIN) {
+        OS_HeapBlockTypeDef *remainder = (OS_HeapBlockTypeDef *)((uint8_t *)block + BLOCK_HEADER_SIZE + size);
+        remainder->size = blockSize(block) - size - BLOCK_HEADER_SIZE;
+        remainder->prevPhys = block;
+        blockSetSize(block, size);
+        blockMarkFree(remainder);
+        insertFreeBlock(heap, remainder);
+    }
+
+    blockMarkUsed(block);
+
+    heap->usedBytes += (uint32_t)(blockSize(block) + BLOCK_HEADER_SIZE);
+    if (heap->usedBytes > heap->peakUsedBytes) {
+        heap->peakUsedBytes = heap->usedBytes;
+    }
+    heap->allocations++;
+
+    OS_CRITICAL_EXIT(pri);
+    return (uint8_t *)block + BLOCK_HEADER_SIZE;
+}
+
+void OS_HeapFree(OS_HeapTypeDef *heap, void *ptr) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    if (ptr == NULL) {
+        return;
+    }
+
+    OS_HeapBlockTypeDef *block = (OS_HeapBlockTypeDef *)((uint8_t *)ptr - BLOCK_HEADER_SIZE);
+    // Double free, or not a pointer returned by OS_HeapAlloc
+    assert(!(block->size & BLOCK_FREE_BIT));
+
+    uint32_t pri = OS_CRITICAL_ENTER();
+
+    heap->usedBytes -= (uint32_t)(blockSize(block) + BLOCK_HEADER_SIZE);
+    heap->allocations--;
+
+    // Coalesce with the previous block
+    if (block->size & BLOCK_PREV_FREE_BIT) {
+        OS_HeapBlockTypeDef *prev = block->prevPhys;
+        removeFreeBlock(heap, prev);
+        blockSetSize(prev, blockSize(prev) + BLOCK_HEADER_SIZE + blockSize(block));
+        block = prev;
+    }
+
+    // Coalesce with the next block
+    OS_HeapBlockTypeDef *next = blockNext(block);
+    if (next->size & BLOCK_FREE_BIT) {
+        removeFreeBlock(heap, next);
+        blockSetSize(block, blockSize(block) + BLOCK_HEADER_SIZE + blockSize(next));
+    }
+
+    blockMarkFree(block);
+    insertFreeBlock(heap, block);
+
+    OS_CRITICAL_EXIT(pri);
+}
+
+
+/* -------------------------------------------- Diagnostics functions --------------------------------------------- */
+uint32_t OS_HeapCheck(OS_HeapTypeDef *heap) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    uint32_t intact = 1;
+    uint32_t physFreeBlocks = 0;
+    uintptr_t bytes = 0;
+
+    // Walk the blocks in address order, up to the sentinel
+    OS_HeapBlockTypeDef *prev = NULL;
+    OS_HeapBlockTypeDef *block = heap->firstBlock;
+    while (intact && blockSize(block) != 0) {
+        uint32_t isFree = (block->size & BLOCK_FREE_BIT) != 0;
+        uint32_t prevFree = (prev != NULL) && (prev->size & BLOCK_FREE_BIT);
+
+        intact &= block->prevPhys == prev;
+        intact &= ((block->size & BLOCK_PREV_FREE_BIT) != 0) == prevFree;
+        // Two free neighbours should always have been coalesced
+        intact &= !(isFree && prevFree);
+        intact &= (blockSize(block) % HEAP_ALIGN_SIZE) == 0;
+
+        if (isFree) {
+            uint32_t fl;
+            uint32_t sl;
+            mappingInsert(blockSize(block), &fl, &sl);
+            intact &= (heap->slBitmap[fl] & (1U << sl)) != 0;
+            physFreeBlocks++;
+        }
+
+        bytes += blockSize(block) + BLOCK_HEADER_SIZE;
+        intact &= bytes <= heap->totalBytes;
+        prev = block;
+        block = blockNext(block);
+    }
+    intact &= bytes == heap->totalBytes;
+
+    // Every listed block has to be free, in the right list, and the bitmaps must match the list heads
+    uint32_t listedFreeBlocks = 0;
+    for (uint32_t fl = 0; intact && fl < HEAP_FL_INDEX_COUNT; fl++) {
+        intact &= ((heap->flBitmap & (1U << fl)) != 0) == (heap->slBitmap[fl] != 0);
+        for (uint32_t sl = 0; intact && sl < HEAP_SL_INDEX_COUNT; sl++) {
+            intact &= ((heap->slBitmap[fl] & (1U << sl)) != 0) == (heap->freeLists[fl][sl] != NULL);
+            for (block = heap->freeLists[fl][sl]; intact && block != NULL; block = block->nextFree) {
+                uint32_t blockFl;
+                uint32_t blockSl;
+                mappingInsert(blockSize(block), &blockFl, &blockSl);
+                intact &= (block->size & BLOCK_FREE_BIT) && blockFl == fl && blockSl == sl;
+                intact &= ++listedFreeBlocks <= physFreeBlocks;
+            }
+        }
+    }
+    intact &= listedFreeBlocks == physFreeBlocks;
+
+    OS_CRITICAL_EXIT(pri);
+    return intact;
+}
+
+void OS_HeapGetStats(OS_HeapTypeDef *heap, OS_HeapStatsTypeDef *stats) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+
+    stats->totalBytes = heap->totalBytes;
+    stats->usedBytes = heap->usedBytes;
+    stats->peakUsedBytes = heap->peakUsedBytes;
+    stats->freeBytes = heap->totalBytes - heap->usedBytes;
+    stats->allocations = heap->allocations;
+    stats->failed = heap->failed;
+    stats->largestFreeBlock = 0;
+    stats->freeBlocks = 0;
+
+    for (uint32_t fl = 0; fl < HEAP_FL_INDEX_COUNT; fl++) {
+        for (uint32_t sl = 0; sl < HEAP_SL_INDEX_COUNT; sl++) {
+            for (OS_HeapBlockTypeDef *block = heap->freeLists[fl][sl]; block != NULL; block = block->nextFree) {
+                stats->freeBlocks++;
+                if (blockSize(block) > stats->largestFreeBlock) {
+                    stats->largestFreeBlock = (uint32_t)blockSize(block);
+                }
+            }
+        }
+    }
+
+    // Largest allocation possible compared to the free memory, headers of the free blocks count as free memory
+    uint32_t freePayload = stats->freeBytes - stats->freeBlocks*BLOCK_HEADER_SIZE;
+    stats->fragmentationPercent = freePayload ? 100 - (uint32_t)(((uint64_t)stats->largestFreeBlock*100) / freePayload) : 0;
+
+    OS_CRITICAL_EXIT(pri);
+}
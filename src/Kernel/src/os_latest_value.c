@@ -0,0 +1,59 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "os_latest_value.h"
+
+
+/* ---------------------------------------- Private function declarations ----------------------------------------- */
+/**
+ * @brief: Copies bytes through volatile pointers, so that the compiler can not move the copy across the accesses
+ *         to the sequence counter
+ */
+static void volatileCopy(volatile uint8_t *dest, const volatile uint8_t *src, uint32_t size);
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+static void volatileCopy(volatile uint8_t *dest, const volatile uint8_t *src, uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) {
+        dest[i] = src[i];
+    }
+}
+
+void OS_LatestValueInit(OS_LatestValueTypeDef *latest, void *dataPtr, uint32_t dataSizeBytes) {
+    latest->dataPtr = dataPtr;
+    latest->dataSizeBytes = dataSizeBytes;
+    latest->sequence = 0;
+    latest->retries = 0;
+}
+
+void OS_LatestValueWrite(OS_LatestValueTypeDef *latest, const void *dataPtr) {
+    // Sequence is 2*completedWrites while idle, mark the write as in progress by making it odd
+    uint32_t sequence = latest->sequence + 1;
+    latest->sequence = sequence;
+
+    // Write number n goes to slot n&1, which is the slot readers are not currently pointed at
+    uint32_t slot = ((sequence + 1) >> 1) & 1;
+    volatileCopy(latest->dataPtr + (slot*latest->dataSizeBytes), dataPtr, latest->dataSizeBytes);
+
+    latest->sequence = sequence + 1;
+}
+
+uint32_t OS_LatestValueRead(OS_LatestValueTypeDef *latest, void *dataPtr) {
+    while (1) {
+        uint32_t before = latest->sequence;
+        // Whether or not a write is in progress, the last completed write is in slot completedWrites&1
+        uint32_t completedWrites = before >> 1;
+        uint32_t slot = completedWrites & 1;
+        volatileCopy(dataPtr, latest->dataPtr + (slot*latest->dataSizeBytes), latest->dataSizeBytes);
+        uint32_t after = latest->sequence;
+
+        // The slot only gets overwritten once the write after the next one has started (sequence 2*completedWrites+3)
+        if ((after - (completedWrites << 1)) < 3) {
+            return completedWrites;
+        }
+
+        latest->retries++;
+    }
+}
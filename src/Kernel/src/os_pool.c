@@ -0,0 +1,136 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "assert.h"
+#include "stddef.h"
+#include "os_pool.h"
+#include "bsp.h"
+#include "os_critical.h"
+
+
+/* ---------------------------------------- Private function declarations ----------------------------------------- */
+static void *listPop(void **list);
+static void listPush(void **list, void *block);
+
+/**
+ * @brief: Puts the block on the free list, or reserves it for a waiting thread. Must be called inside a critical section
+ * @return: 1 if a waiting thread has to be signaled
+ */
+static uint32_t poolRelease(OS_PoolTypeDef *pool, void *block);
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+static void *listPop(void **list) {
+    void *block = *list;
+    if (block != NULL) {
+        *list = *(void **)block;
+    }
+    return block;
+}
+
+static void listPush(void **list, void *block) {
+    *(void **)block = *list;
+    *list = block;
+}
+
+void OS_PoolInit(OS_PoolTypeDef *pool, void *memPtr, uint32_t blockSize, uint32_t blocks) {
+    // Every block has to be able to hold the free list link, and the links have to stay aligned
+    assert(blockSize == OS_POOL_BLOCK_SIZE(blockSize) && blockSize != 0);
+    assert(((uintptr_t)memPtr % sizeof(void *)) == 0);
+
+    OS_InitSemaphore(&pool->semaphore, SEMAPHORE_FLAG);
+    pool->memPtr = memPtr;
+    pool->blockSize = blockSize;
+    pool->blocks = blocks;
+    pool->inUse = 0;
+    pool->highWater = 0;
+    pool->failed = 0;
+    pool->freeList = NULL;
+    pool->handoffList = NULL;
+
+    // Push in reverse so that blocks get allocated in address order
+    for (uint32_t i = blocks; i > 0; i--) {
+        listPush(&pool->freeList, pool->memPtr + ((i-1)*blockSize));
+    }
+}
+
+void *OS_PoolAlloc(OS_PoolTypeDef *pool) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    uint32_t pri = OS_CRITICAL_ENTER();
+
+    void *block = listPop(&pool->freeList);
+    if (block != NULL) {
+        pool->inUse++;
+        if (pool->inUse > pool->highWater) {
+            pool->highWater = pool->inUse;
+        }
+    } else {
+        pool->failed++;
+    }
+
+    OS_CRITICAL_EXIT(pri);
+    return block;
+}
+
+void *OS_PoolAllocBlocking(OS_PoolTypeDef *pool) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+
+    void *block = listPop(&pool->freeList);
+    if (block != NULL) {
+        pool->inUse++;
+        if (pool->inUse > pool->highWater) {
+            pool->highWater = pool->inUse;
+        }
+        OS_CRITICAL_EXIT(pri);
+        return block;
+    }
+
+    // The semaphore itself counts the waiters, so a free always finds a waiter on the blocked list for every count,
+    // and a waiter whose thread is deleted takes its count with it. The context switch stays pending until the
+    // section exits.
+    OS_Wait(&pool->semaphore);
+    OS_CRITICAL_EXIT(pri);
+
+    // OS_PoolFree reserves a block on the hand-off list for every waiter it wakes, so there is no need to retry
+    pri = OS_CRITICAL_ENTER();
+    block = listPop(&pool->handoffList);
+    OS_CRITICAL_EXIT(pri);
+    return block;
+}
+
+static uint32_t poolRelease(OS_PoolTypeDef *pool, void *block) {
+    // Make sure the block belongs to this pool
+    assert((uint8_t *)block >= pool->memPtr && (uint8_t *)block < pool->memPtr + (pool->blocks*pool->blockSize));
+    assert((((uint8_t *)block - pool->memPtr) % pool->blockSize) == 0);
+
+    // The block stays in use, it just changes owner to the waiting thread
+    if (pool->semaphore.value < 0) {
+        listPush(&pool->handoffList, block);
+        return 1;
+    }
+
+    listPush(&pool->freeList, block);
+    pool->inUse--;
+    return 0;
+}
+
+void OS_PoolFree(OS_PoolTypeDef *pool, void *block) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    // Signaled inside the section, so that the next free already sees the waiter as woken
+    uint32_t pri = OS_CRITICAL_ENTER();
+    if (poolRelease(pool, block)) {
+        OS_Signal(&pool->semaphore);
+    }
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_PoolFreeFromISR(OS_PoolTypeDef *pool, void *block) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    uint32_t pri = OS_CRITICAL_ENTER();
+    if (poolRelease(pool, block)) {
+        OS_SignalFromISR(&pool->semaphore);
+    }
+    OS_CRITICAL_EXIT(pri);
+}
@@ -0,0 +1,74 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "os_profiler.h"
+#include "string.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "bsp.h"
+
+#if PROFILER_ENABLED
+
+#if (PROFILER_BUCKETS & (PROFILER_BUCKETS - 1)) != 0
+#error "PROFILER_BUCKETS must be a power of two"
+#endif
+
+
+/* ----------------------------------------------- Global variables ----------------------------------------------- */
+OS_ProfilerBufferTypeDef osProfilerBuffer = {
+    .magic = PROFILER_MAGIC,
+    .entrySize = sizeof(OS_ProfilerEntryTypeDef),
+    .capacity = PROFILER_BUCKETS,
+    .samples = 0,
+    .dropped = 0
+};
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+void OS_ProfilerSysTick(uint32_t pc) {
+    OS_ProfilerSample(pc, runPtr->id);
+    SysTick_Handler();
+}
+
+void OS_ProfilerSample(uint32_t pc, uint8_t threadId) {
+    uint32_t pri = OS_CriticalEnter();
+    osProfilerBuffer.samples++;
+
+    // Thumb instructions are halfword aligned, so drop the lowest bit before mixing in the thread id
+    uint32_t hash = ((pc >> 1) ^ ((uint32_t)threadId << 24)) * 0x9E3779B1U;
+    uint32_t index = (hash >> 16) & (PROFILER_BUCKETS - 1);
+
+    for (uint32_t probes = 0; probes < PROFILER_BUCKETS; probes++) {
+        OS_ProfilerEntryTypeDef *entry = &osProfilerBuffer.entries[index];
+        if (entry->count == 0) {
+            entry->pc = pc;
+            entry->threadId = threadId;
+            entry->count = 1;
+            OS_CriticalExit(pri);
+            return;
+        }
+
+        if (entry->pc == pc && entry->threadId == threadId) {
+            entry->count++;
+            OS_CriticalExit(pri);
+            return;
+        }
+
+        index = (index + 1) & (PROFILER_BUCKETS - 1);
+    }
+
+    osProfilerBuffer.dropped++;
+    OS_CriticalExit(pri);
+}
+
+void OS_ProfilerReset(void) {
+    uint32_t pri = OS_CriticalEnter();
+    memset(osProfilerBuffer.entries, 0, sizeof(osProfilerBuffer.entries));
+    osProfilerBuffer.samples = 0;
+    osProfilerBuffer.dropped = 0;
+    OS_CriticalExit(pri);
+}
+
+#endif
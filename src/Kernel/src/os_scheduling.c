@@ -6,14 +6,57 @@
 #include "os_scheduling.h"
 #include "os_core.h"
 #include "os_threads.h"
+#include "os_trace.h"
 #include "bsp.h"
+#include "os_critical.h"
+#include "os_server.h"
 
 uint32_t firstSwitch = 1;
+// Set when the running thread gives up the CPU itself, cleared by the scheduler
+static uint32_t voluntarySuspend = 0;
+// Set by the FromISR functions, cleared when the scheduler is triggered or runs for another reason
+static volatile uint32_t reschedulePending = 0;
+
+/**
+ * @brief: Tells if the thread or its server has used up its budget, and must not be scheduled for now. A thread
+ *         running on a priority inherited from a mutex waiter is not throttled, the waiter would be stalled until
+ *         the next replenishment as well. It is throttled at the first scheduling after the priority is restored.
+ */
+static uint32_t OS_IsThrottled(const OS_TCBTypeDef *thread) {
+    // Inheritance is the only way the priority differs from the base, and only while a waiter is boosting it
+    if (thread->ownedMutexes != NULL && thread->priority != thread->basePriority) {
+        return 0;
+    }
+    if (thread->server != NULL && thread->server->throttled) {
+        return 1;
+    }
+#if THREAD_BUDGET_ENABLED
+    if (thread->budgetThrottled) {
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief: Finds the first thread from the given one onwards in the ready list that is allowed to run, throttled
+ *         threads are passed over
+ * @return: The thread, NULL if there is none
+ */
+static OS_TCBTypeDef *OS_FirstRunnable(OS_TCBTypeDef *thread) {
+    while (thread != NULL && OS_IsThrottled(thread)) {
+        thread = thread->next;
+    }
+    return thread;
+}
 
 void OS_Suspend(OS_Suspend_Cause cause) {
+    // Unblocking a higher priority thread preempts the running one, every other cause is the threads own doing
+    voluntarySuspend = (cause != OS_SUSPEND_UNBLOCK);
+
     // When a periodic thread has ran fully and given up control, it should be removed from ready list to prevent it from running again
     if (cause == OS_SUSPEND_RELINQUISH) {
-        if (runPtr->basePeriod != 0) {
+        if (runPtr->basePeriod != 0 || runPtr->tableDriven) {
             runPtr->hasFullyRan = 1;
             OS_ReadyListRemove(runPtr);
         }
@@ -23,22 +66,83 @@ void OS_Suspend(OS_Suspend_Cause cause) {
 }
 
 void OS_Sleep(uint32_t milliseconds) {
-    uint32_t priority = OS_CriticalEnter();
+    uint32_t priority = OS_CRITICAL_ENTER();
     runPtr->sleep = milliseconds;
-    OS_ReadyListRemove(runPtr);
-    OS_SleepListInsert(runPtr);
-    OS_CriticalExit(priority);
+    runPtr->wakeTick = OS_WakeTickFromMillis(milliseconds);
+    OS_ReadyListRemoveUnlocked(runPtr);
+    OS_SleepListInsertUnlocked(runPtr);
+    OS_CRITICAL_EXIT(priority);
     OS_Suspend(OS_SUSPEND_SLEEP);
 }
 
+uint32_t OS_SleepUntil(uint64_t *lastWakeTick, uint32_t periodMillis) {
+    uint32_t priority = OS_CRITICAL_ENTER();
+    uint64_t now = OS_GetSysTickCount();
+    uint64_t wakeTick = *lastWakeTick + OS_MillisToTicks(periodMillis);
+    *lastWakeTick = wakeTick;
+
+    // Work took longer than the period, the next period has already started
+    if (wakeTick <= now) {
+        OS_CRITICAL_EXIT(priority);
+        return 0;
+    }
+
+    runPtr->sleep = (uint32_t)(wakeTick - now) * SYS_TICK_PERIOD_MILLIS;
+    runPtr->wakeTick = wakeTick;
+    OS_ReadyListRemoveUnlocked(runPtr);
+    OS_SleepListInsertUnlocked(runPtr);
+    OS_CRITICAL_EXIT(priority);
+    OS_Suspend(OS_SUSPEND_SLEEP);
+    return 1;
+}
+
+void OS_RequestRescheduleFromISR(void) {
+    reschedulePending = 1;
+}
+
+void OS_YieldFromISR(void) {
+    if (reschedulePending) {
+        reschedulePending = 0;
+        // The interrupted thread did not give up the CPU itself
+        voluntarySuspend = 0;
+        BSP_TriggerPendSV();
+    }
+}
+
+void OS_YieldIfPending(void) {
+    if (reschedulePending) {
+        reschedulePending = 0;
+        voluntarySuspend = 1;
+        BSP_TriggerPendSV();
+    }
+}
+
 void OS_Schedule(void) {
-    uint32_t pri = OS_CriticalEnter();
+    uint32_t pri = OS_CRITICAL_ENTER();
+    // Whatever the ISR wanted to run is picked up by this run as well
+    reschedulePending = 0;
+#if STACK_CHECK_ENABLED
+    // Context of the outgoing thread has just been saved, so its stack is at its deepest point for now
+    OS_CheckThreadStack(runPtr);
+#endif
+#if THREAD_BUDGET_ENABLED
+    // Charge the outgoing thread before choosing, a thread that just used up its budget is not picked again
+    OS_AccountBudget();
+#endif
     OS_TCBTypeDef *nextToRun = idlePtr;
-    OS_TCBTypeDef *tmpPtr = readyHeadPtr;
+    OS_TCBTypeDef *tmpPtr = OS_FirstRunnable(readyHeadPtr);
 
     if (tmpPtr == NULL) {
+        if (runPtr != idlePtr) {
+            OS_TRACE(TRACE_EVENT_SWITCH, idlePtr, runPtr);
+        }
+#if THREAD_STATS_ENABLED
+        OS_AccountContextSwitch(idlePtr, voluntarySuspend);
+#endif
+        voluntarySuspend = 0;
         runPtr = idlePtr;
-        OS_CriticalExit(pri);
+        OS_ReapZombieThread();
+        OS_CRITICAL_EXIT(pri);
         return;
     }
     
@@ -49,13 +153,25 @@ void OS_Schedule(void) {
     nextToRun = tmpPtr;
     // If currently running thread is highest priority, check if the next thread in ready list has same priority (for round robin)
     if (tmpPtr == runPtr) {
-        if (tmpPtr->next != NULL) {
-            if (tmpPtr->next->priority == runPtr->priority) {
-                nextToRun = tmpPtr->next;
+        OS_TCBTypeDef *nextPtr = OS_FirstRunnable(tmpPtr->next);
+        if (nextPtr != NULL) {
+            if (nextPtr->priority == runPtr->priority) {
+                nextToRun = nextPtr;
             }
         }
     }
 
+    if (nextToRun != runPtr) {
+        OS_TRACE(TRACE_EVENT_SWITCH, nextToRun, runPtr);
+    }
+#if THREAD_STATS_ENABLED
+    OS_AccountContextSwitch(nextToRun, voluntarySuspend);
+#endif
+#if WAKEUP_LATENCY_ENABLED
+    OS_RecordWakeupLatency(nextToRun);
+#endif
+    voluntarySuspend = 0;
     runPtr = nextToRun;
-    OS_CriticalExit(pri);
+    OS_ReapZombieThread();
+    OS_CRITICAL_EXIT(pri);
 }
@@ -0,0 +1,117 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "os_select.h"
+#include "stddef.h"
+#include "os_threads.h"
+#include "os_scheduling.h"
+#include "os_semaphore.h"
+#include "os_buffers.h"
+#include "os_critical.h"
+
+
+/* ----------------------------------------------- Global variables ----------------------------------------------- */
+// Threads waiting in OS_WaitAny, highest priority first, so that a ready object only has to look until the first match
+static OS_TCBTypeDef *selectHeadPtr = NULL;
+
+
+/* ---------------------------------------- Private function declarations ----------------------------------------- */
+/**
+ * @brief: Checks whether an object is ready, and acquires it if it is a semaphore
+ * @return: 1 if the object was ready
+ */
+static uint32_t tryTakeObject(const OS_SelectObjectTypeDef *selectObject);
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+static uint32_t tryTakeObject(const OS_SelectObjectTypeDef *selectObject) {
+    if (selectObject->type == SELECT_SEMAPHORE) {
+        return OS_TryWait(selectObject->object);
+    }
+
+    OS_BufferTypeDef *bufferObject = selectObject->object;
+    return bufferObject->spaceRemaining < bufferObject->elements;
+}
+
+int32_t OS_WaitAny(const OS_SelectObjectTypeDef *objects, uint32_t count, uint32_t timeoutMillis) {
+    uint32_t priority = OS_CRITICAL_ENTER();
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (tryTakeObject(&objects[i])) {
+            OS_CRITICAL_EXIT(priority);
+            return (int32_t)i;
+        }
+    }
+
+    if (timeoutMillis == 0) {
+        OS_CRITICAL_EXIT(priority);
+        return OS_WAIT_TIMEOUT;
+    }
+
+    // The waiting thread sleeps, so the timeout is handled by the SysTick like any other sleep. The objects wake it
+    // early through OS_SelectWakeWaiter, which overwrites the result.
+    runPtr->waitObjects = objects;
+    runPtr->waitCount = count;
+    runPtr->waitResult = OS_WAIT_TIMEOUT;
+    runPtr->sleep = timeoutMillis;
+    runPtr->wakeTick = OS_WakeTickFromMillis(timeoutMillis);
+    OS_ReadyListRemoveUnlocked(runPtr);
+    OS_SleepListInsertUnlocked(runPtr);
+    OS_SelectListInsertUnlocked(runPtr);
+
+    OS_CRITICAL_EXIT(priority);
+    OS_Suspend(OS_SUSPEND_BLOCK);
+    return runPtr->waitResult;
+}
+
+OS_TCBTypeDef *OS_SelectWakeWaiter(const void *object) {
+    // Waiters of the same priority are in the order they started waiting, so the longest waiting one wins ties
+    for (OS_TCBTypeDef *waiter = selectHeadPtr; waiter != NULL; waiter = waiter->nextSelectWaiter) {
+        for (uint32_t i = 0; i < waiter->waitCount; i++) {
+            if (waiter->waitObjects[i].object == object) {
+                OS_SelectListRemoveUnlocked(waiter);
+                waiter->waitResult = (int32_t)i;
+                waiter->waitObjects = NULL;
+                waiter->sleep = 0;
+                OS_SleepListRemoveUnlocked(waiter);
+                OS_ReadyListInsertUnlocked(waiter);
+                return waiter;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+void OS_SelectListInsertUnlocked(OS_TCBTypeDef *thread) {
+    OS_TCBTypeDef **linkPtr = &selectHeadPtr;
+    while (*linkPtr != NULL && (*linkPtr)->priority <= thread->priority) {
+        linkPtr = &(*linkPtr)->nextSelectWaiter;
+    }
+
+    thread->nextSelectWaiter = *linkPtr;
+    *linkPtr = thread;
+}
+
+void OS_SelectListRemoveUnlocked(OS_TCBTypeDef *thread) {
+    OS_TCBTypeDef **linkPtr = &selectHeadPtr;
+    while (*linkPtr != NULL) {
+        if (*linkPtr == thread) {
+            *linkPtr = thread->nextSelectWaiter;
+            break;
+        }
+
+        linkPtr = &(*linkPtr)->nextSelectWaiter;
+    }
+
+    thread->nextSelectWaiter = NULL;
+}
+
+/**
+ * @brief: Resets the internal state of the module. Only compiled for tests.
+ */
+void OS_ResetSelect(void) {
+    selectHeadPtr = NULL;
+}
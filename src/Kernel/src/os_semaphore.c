@@ -9,6 +9,9 @@
 #include "os_scheduling.h"
 #include "os_core.h"
 #include "os_threads.h"
+#include "os_select.h"
+#include "os_trace.h"
+#include "os_critical.h"
 
 
 /* ---------------------------------------- Private function declarations ---------------------------------------- */
@@ -39,6 +42,19 @@ static void semaphoreRemoveOwner(OS_SemaphoreObjectTypeDef *semaphoreObject);
 
 static void reInsertToList(OS_TCBTypeDef *ptr);
 
+/**
+ * @brief: Recomputes the priority of the semaphore owner from the threads still blocked on its mutexes, and then
+ *         of every owner further down the chain the owner itself is blocked on. Must be called inside a critical section
+ * @param semaphoreObject: The semaphore that lost a waiter
+ */
+static void restoreInheritedPriority(OS_SemaphoreObjectTypeDef *semaphoreObject);
+
+/**
+ * @brief: Signals the semaphore, must be called inside a critical section
+ * @return: 1 if a thread with higher priority than the currently running one was woken
+ */
+static uint32_t signalSemaphore(OS_SemaphoreObjectTypeDef *semaphoreObject);
+
 
 /* -------------------------------- Semaphore initialization and modification ------------------------------------ */
 void OS_InitSemaphore(OS_SemaphoreObjectTypeDef *semaphoreObject, SemaphoreType type) {
@@ -53,16 +69,33 @@ void OS_InitSemaphore(OS_SemaphoreObjectTypeDef *semaphoreObject, SemaphoreType
     semaphoreObject->owner = NULL;
     semaphoreObject->priorityHasBeenGranted = 0;
     semaphoreObject->priorityLevelGranted = 0;
+    semaphoreObject->nextOwned = NULL;
 }
 
 static void semaphoreSetOwner(OS_SemaphoreObjectTypeDef *semaphoreObject, OS_TCBTypeDef *newOwner) {
     if (semaphoreObject->type != SEMAPHORE_FLAG) {
         semaphoreObject->owner = newOwner;
+        // Keep track of the mutexes held by each thread, so that they can be released if the thread is deleted
+        semaphoreObject->nextOwned = newOwner->ownedMutexes;
+        newOwner->ownedMutexes = semaphoreObject;
     }
 }
 
 static void semaphoreRemoveOwner(OS_SemaphoreObjectTypeDef *semaphoreObject) {
+    if (semaphoreObject->owner != NULL) {
+        OS_SemaphoreObjectTypeDef **linkPtr = &semaphoreObject->owner->ownedMutexes;
+        while (*linkPtr != NULL) {
+            if (*linkPtr == semaphoreObject) {
+                *linkPtr = semaphoreObject->nextOwned;
+                break;
+            }
+
+            linkPtr = &(*linkPtr)->nextOwned;
+        }
+    }
+
     semaphoreObject->owner = NULL;
+    semaphoreObject->nextOwned = NULL;
 }
 
 
@@ -75,8 +108,8 @@ static int32_t unblockThread(OS_SemaphoreObjectTypeDef *semaphoreObject) {
         // Ordered round robin list, first element found is highest priority or longest waiting
         if (tmpPtr->blockPtr == semaphoreObject) {
             tmpPtr->blockPtr = NULL;
-            OS_BlockedListRemove(tmpPtr);
-            OS_ReadyListInsert(tmpPtr);
+            OS_BlockedListRemoveUnlocked(tmpPtr);
+            OS_ReadyListInsertUnlocked(tmpPtr);
             semaphoreSetOwner(semaphoreObject, tmpPtr);
 
             // Return one if the unblocked thread is higher priority than currently executing thread
@@ -132,8 +165,30 @@ static void removeDynamicPriorityFromOwner(OS_SemaphoreObjectTypeDef *semaphoreO
 }
 
 void OS_Signal(OS_SemaphoreObjectTypeDef *semaphoreObject) {
-    uint32_t priority = OS_CriticalEnter();
+    uint32_t priority = OS_CRITICAL_ENTER();
+    uint32_t shouldSuspend = signalSemaphore(semaphoreObject);
+    OS_CRITICAL_EXIT(priority);
+
+    // Currently running thread will suspend if the unblocked task was higher priority
+    if (shouldSuspend == 1) {
+        OS_Suspend(OS_SUSPEND_UNBLOCK);
+    }
+}
+
+void OS_SignalFromISR(OS_SemaphoreObjectTypeDef *semaphoreObject) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    assert(semaphoreObject->type == SEMAPHORE_FLAG);
+
+    uint32_t priority = OS_CRITICAL_ENTER();
+    if (signalSemaphore(semaphoreObject)) {
+        OS_RequestRescheduleFromISR();
+    }
+    OS_CRITICAL_EXIT(priority);
+}
+
+static uint32_t signalSemaphore(OS_SemaphoreObjectTypeDef *semaphoreObject) {
     uint32_t shouldSuspend = 0;
+    OS_TRACE(TRACE_EVENT_SIGNAL, runPtr, semaphoreObject);
 
     semaphoreObject->value += 1;
     if (semaphoreObject->value > 1) {
@@ -149,29 +204,79 @@ void OS_Signal(OS_SemaphoreObjectTypeDef *semaphoreObject) {
     // If someone is waiting for this semaphore, unblock the highest priority thread on the semaphores block list
     if (semaphoreObject->value < 1) {
         shouldSuspend = unblockThread(semaphoreObject);
+    } else {
+        // Nobody is blocked on the semaphore itself, hand it over to a thread waiting for it in OS_WaitAny instead
+        OS_TCBTypeDef *waiter = OS_SelectWakeWaiter(semaphoreObject);
+        if (waiter != NULL) {
+            semaphoreObject->value = 0;
+            semaphoreSetOwner(semaphoreObject, waiter);
+            shouldSuspend = (waiter->priority < runPtr->priority);
+        }
     }
 
-    OS_CriticalExit(priority);
+    return shouldSuspend;
+}
 
-    // Currently running thread will suspend if the unblocked task was higher priority
-    if (shouldSuspend == 1) {
-        OS_Suspend(OS_SUSPEND_UNBLOCK);
+
+static void restoreInheritedPriority(OS_SemaphoreObjectTypeDef *semaphoreObject) {
+    while (semaphoreObject != NULL && semaphoreObject->owner != NULL) {
+        OS_TCBTypeDef *owner = semaphoreObject->owner;
+        uint32_t newPriority = owner->basePriority;
+        semaphoreObject->priorityHasBeenGranted = 0;
+        semaphoreObject->priorityLevelGranted = 0;
+
+        // Ordered by priority, so the first waiter found on each semaphore is the one that would have granted priority
+        OS_TCBTypeDef *tmpPtr = blockHeadPtr;
+        while (tmpPtr != NULL) {
+            if (tmpPtr->blockPtr == semaphoreObject && !semaphoreObject->priorityHasBeenGranted &&
+                tmpPtr->priority < owner->basePriority) {
+                semaphoreObject->priorityHasBeenGranted = 1;
+                semaphoreObject->priorityLevelGranted = tmpPtr->priority;
+            }
+            if (tmpPtr->blockPtr->owner == owner && tmpPtr->priority < newPriority) {
+                newPriority = tmpPtr->priority;
+            }
+
+            tmpPtr = tmpPtr->next;
+        }
+
+        // Owners further down the chain only inherited what this owner had
+        if (newPriority == owner->priority) {
+            return;
+        }
+
+        owner->priority = newPriority;
+        reInsertToList(owner);
+        semaphoreObject = owner->blockPtr;
+    }
+}
+
+void OS_CancelWaitUnlocked(OS_TCBTypeDef *thread) {
+    OS_SemaphoreObjectTypeDef *semaphoreObject = thread->blockPtr;
+    OS_BlockedListRemoveUnlocked(thread);
+    thread->blockPtr = NULL;
+    // Undo the decrement done by OS_Wait, the thread will never take the semaphore
+    semaphoreObject->value += 1;
+
+    if (semaphoreObject->type == SEMAPHORE_MUTEX) {
+        // The owner may have inherited its priority from the thread that stopped waiting
+        restoreInheritedPriority(semaphoreObject);
     }
 }
 
 
 /* ----------------------------------------- Semaphore acquisition ------------------------------------------------ */
 static void reInsertToList(OS_TCBTypeDef *ptr) {
-    if (ptr->sleep == 0) {
-        if (ptr->basePeriod == 0 || !ptr->hasFullyRan) {
-            if (ptr->blockPtr != NULL) {
-                OS_BlockedListRemove(ptr);
-                OS_BlockedListInsert(ptr);
-            } else {
-                OS_ReadyListRemove(ptr);
-                OS_ReadyListInsert(ptr);
-            }
-        }
+    // Only the ready, blocked and select lists are ordered by priority
+    if (ptr->state == BLOCKED) {
+        OS_BlockedListRemoveUnlocked(ptr);
+        OS_BlockedListInsertUnlocked(ptr);
+    } else if (ptr->state == READY) {
+        OS_ReadyListRemoveUnlocked(ptr);
+        OS_ReadyListInsertUnlocked(ptr);
+    } else if (ptr->state == ASLEEP && ptr->waitObjects != NULL) {
+        OS_SelectListRemoveUnlocked(ptr);
+        OS_SelectListInsertUnlocked(ptr);
     }
 }
 
@@ -209,7 +314,7 @@ static void grantDynamicPriorityToOwner(OS_SemaphoreObjectTypeDef *semaphoreObje
 }
 
 void OS_Wait(OS_SemaphoreObjectTypeDef *semaphoreObject) {
-    uint32_t priority = OS_CriticalEnter();
+    uint32_t priority = OS_CRITICAL_ENTER();
     semaphoreObject->value -= 1;
 
     // If no semaphore available, block the thread on the semaphore and suspend the thread
@@ -223,9 +328,10 @@ void OS_Wait(OS_SemaphoreObjectTypeDef *semaphoreObject) {
             }
         }
 
-        OS_ReadyListRemove(runPtr);
-        OS_BlockedListInsert(runPtr);
+        OS_ReadyListRemoveUnlocked(runPtr);
+        OS_BlockedListInsertUnlocked(runPtr);
         runPtr->blockPtr = semaphoreObject;
+        OS_TRACE(TRACE_EVENT_BLOCK, runPtr, semaphoreObject);
 
         // Only mutex semaphores implement priority inheritance
         if (semaphoreObject->type == SEMAPHORE_MUTEX) {
@@ -235,10 +341,25 @@ void OS_Wait(OS_SemaphoreObjectTypeDef *semaphoreObject) {
             }
         }
 
-        OS_CriticalExit(priority);
+        OS_CRITICAL_EXIT(priority);
         OS_Suspend(OS_SUSPEND_BLOCK);
     } else {
         semaphoreSetOwner(semaphoreObject, runPtr);
-        OS_CriticalExit(priority);
+        OS_TRACE(TRACE_EVENT_WAIT, runPtr, semaphoreObject);
+        OS_CRITICAL_EXIT(priority);
     }
-}
\ No newline at end of file
+}
+
+uint32_t OS_TryWait(OS_SemaphoreObjectTypeDef *semaphoreObject) {
+    uint32_t priority = OS_CRITICAL_ENTER();
+    uint32_t acquired = 0;
+
+    if (semaphoreObject->value > 0) {
+        semaphoreObject->value -= 1;
+        semaphoreSetOwner(semaphoreObject, runPtr);
+        acquired = 1;
+    }
+
+    OS_CRITICAL_EXIT(priority);
+    return acquired;
+}
@@ -0,0 +1,78 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "stddef.h"
+#include "assert.h"
+#include "os_server.h"
+#include "os_threads.h"
+#include "os_critical.h"
+
+
+/* --------------------------------------------- Private variables ----------------------------------------------- */
+static OS_ServerTypeDef *serverList = NULL;
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+void OS_ResetServers(void) {
+    serverList = NULL;
+}
+
+void OS_ServerInit(OS_ServerTypeDef *server, uint32_t budgetMillis, uint32_t periodMillis) {
+    server->budgetTicks = OS_MillisToTicks(budgetMillis);
+    server->periodTicks = OS_MillisToTicks(periodMillis);
+    assert(server->budgetTicks <= server->periodTicks);
+    server->remaining = server->budgetTicks;
+    server->throttled = 0;
+    server->exhaustions = 0;
+
+    uint32_t pri = OS_CRITICAL_ENTER();
+    server->nextReplenish = OS_GetSysTickCount() + server->periodTicks;
+    server->next = serverList;
+    serverList = server;
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_ServerAttach(OS_ServerTypeDef *server, OS_TCBTypeDef *thread) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    thread->server = server;
+    OS_CRITICAL_EXIT(pri);
+}
+
+uint32_t OS_ServerSysTick(uint64_t tickCount) {
+    uint32_t shouldRunScheduler = 0;
+
+    // The tick that just ended is charged to whoever it interrupted
+    uint32_t pri = OS_CRITICAL_ENTER();
+    OS_ServerTypeDef *charged = runPtr->server;
+    if (charged != NULL && !charged->throttled) {
+        charged->remaining--;
+        if (charged->remaining == 0) {
+            charged->throttled = 1;
+            charged->exhaustions++;
+            shouldRunScheduler = 1;
+        }
+    }
+    OS_CRITICAL_EXIT(pri);
+
+    // Servers are only added, so each one can be handled in a critical section of its own
+    for (OS_ServerTypeDef *server = serverList; server != NULL; server = server->next) {
+        pri = OS_CRITICAL_ENTER();
+        if (server->nextReplenish <= tickCount) {
+            // Replenishments stay on the grid of the period, even if the SysTick fell behind
+            do {
+                server->nextReplenish += server->periodTicks;
+            } while (server->nextReplenish <= tickCount);
+
+            server->remaining = server->budgetTicks;
+            if (server->throttled) {
+                server->throttled = 0;
+                shouldRunScheduler = 1;
+            }
+        }
+        OS_CRITICAL_EXIT(pri);
+    }
+
+    return shouldRunScheduler;
+}
@@ -0,0 +1,145 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "stddef.h"
+#include "assert.h"
+#include "os_table.h"
+#include "os_threads.h"
+#include "os_trace.h"
+#include "os_critical.h"
+
+
+/* --------------------------------------------- Private variables ----------------------------------------------- */
+static OS_ScheduleTableTypeDef *activeTable = NULL;
+// Every initialized table, searched when a table thread is deleted
+static OS_ScheduleTableTypeDef *tablesHeadPtr = NULL;
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+OS_TCBTypeDef *OS_CreateTableThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize,
+                                    const char *identifier) {
+    OS_TCBTypeDef *thread = OS_CreateThread(function, stkPtr, stackSize, TABLE_THREAD_PRIORITY, identifier);
+    if (thread == NULL) {
+        return NULL;
+    }
+
+    // Same state as a periodic thread waiting for its next release
+    uint32_t pri = OS_CRITICAL_ENTER();
+    OS_ReadyListRemoveUnlocked(thread);
+#if WAKEUP_LATENCY_ENABLED
+    // Stamped when it was put on the ready list, the first release stamps it again
+    thread->wakeupPending = 0;
+#endif
+    thread->tableDriven = 1;
+    thread->hasFullyRan = 1;
+    OS_CRITICAL_EXIT(pri);
+
+    return thread;
+}
+
+void OS_TableInit(OS_ScheduleTableTypeDef *table, const OS_TableEntryTypeDef *entries, uint32_t length,
+                  uint32_t hyperperiod, OS_TCBTypeDef **threads) {
+    assert(hyperperiod > 0);
+    for (uint32_t i = 0; i < length; i++) {
+        assert(entries[i].offset < hyperperiod);
+        // One entry per offset keeps the work done in the SysTick constant
+        assert(i == 0 || entries[i].offset > entries[i-1].offset);
+    }
+
+    table->entries = entries;
+    table->length = length;
+    table->hyperperiod = hyperperiod;
+    table->threads = threads;
+    table->position = 0;
+    table->nextEntry = 0;
+    table->overruns = 0;
+
+    uint32_t pri = OS_CRITICAL_ENTER();
+    OS_ScheduleTableTypeDef *tmpPtr = tablesHeadPtr;
+    while (tmpPtr != NULL && tmpPtr != table) {
+        tmpPtr = tmpPtr->next;
+    }
+    // A table initialized again is already in the list
+    if (tmpPtr == NULL) {
+        table->next = tablesHeadPtr;
+        tablesHeadPtr = table;
+    }
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_TableStart(OS_ScheduleTableTypeDef *table) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    table->position = 0;
+    table->nextEntry = 0;
+    activeTable = table;
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_TableStop(void) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    activeTable = NULL;
+    OS_CRITICAL_EXIT(pri);
+}
+
+uint32_t OS_TableSysTick(void) {
+    uint32_t shouldRunScheduler = 0;
+
+    uint32_t pri = OS_CRITICAL_ENTER();
+    OS_ScheduleTableTypeDef *table = activeTable;
+    if (table == NULL) {
+        OS_CRITICAL_EXIT(pri);
+        return 0;
+    }
+
+    OS_TCBTypeDef *released = NULL;
+    if (table->nextEntry < table->length && table->entries[table->nextEntry].offset == table->position) {
+        OS_TCBTypeDef *thread = table->threads[table->entries[table->nextEntry].task];
+        table->nextEntry++;
+
+        // Deleted threads have been cleared from the table
+        if (thread != NULL) {
+            if (thread->hasFullyRan) {
+                OS_ReadyListInsertUnlocked(thread);
+                thread->hasFullyRan = 0;
+                released = thread;
+                shouldRunScheduler = (thread->priority < runPtr->priority);
+            } else {
+                table->overruns++;
+            }
+        }
+    }
+
+    table->position++;
+    if (table->position == table->hyperperiod) {
+        table->position = 0;
+        table->nextEntry = 0;
+    }
+    OS_CRITICAL_EXIT(pri);
+
+    if (released != NULL) {
+        OS_TRACE(TRACE_EVENT_WAKE, released, 0);
+    }
+
+    return shouldRunScheduler;
+}
+
+void OS_TableRemoveThreadUnlocked(OS_TCBTypeDef *thread) {
+    for (OS_ScheduleTableTypeDef *table = tablesHeadPtr; table != NULL; table = table->next) {
+        // The array has no length of its own, but every task in it has entries
+        for (uint32_t i = 0; i < table->length; i++) {
+            if (table->threads[table->entries[i].task] == thread) {
+                table->threads[table->entries[i].task] = NULL;
+            }
+        }
+    }
+}
+
+/**
+ * @brief: Resets the internal state of the module. Only compiled for tests.
+ */
+void OS_ResetTables(void) {
+    activeTable = NULL;
+    tablesHeadPtr = NULL;
+}
@@ -8,13 +8,49 @@
 #include "string.h"
 #include "assert.h"
 #include "os_core.h"
+#include "os_semaphore.h"
+#include "os_scheduling.h"
+#include "os_pool.h"
+#include "os_critical.h"
+#include "os_select.h"
+#include "os_table.h"
 
 
 
 /* ---------------------------------------- Private function declarations ----------------------------------------- */
 static void OS_ValidateTCB(uint32_t stackSize);
 static void OS_PeriodicListInsert(OS_TCBTypeDef *thread);
+static void OS_PeriodicListRemove(OS_TCBTypeDef *thread);
 
+/**
+ * @brief: Takes a TCB from the never used TCBs, or from the free list of deleted ones
+ * @return: Pointer to the TCB, or NULL if all of them are in use
+ */
+static OS_TCBTypeDef *OS_AllocateTCB(void);
+
+/**
+ * @brief: Returns the TCB and the stack of a deleted thread for reuse. Must not be called for the running thread,
+ *         since its stack is still in use until the context has been switched.
+ */
+static void OS_FreeTCB(OS_TCBTypeDef *thread);
+
+/**
+ * @brief: Removes the thread from whichever list it is in, and releases everything it holds
+ */
+static void OS_DetachThread(OS_TCBTypeDef *thread);
+
+#if THREAD_BUDGET_ENABLED
+/**
+ * @brief: Inserts the thread in to the list of budgeted threads, ordered by the end of the window so that only the
+ *         head needs to be checked every SysTick. Must be called inside a critical section.
+ */
+static void OS_BudgetListInsert(OS_TCBTypeDef *thread);
+
+/**
+ * @brief: Removes the thread from the list of budgeted threads. Must be called inside a critical section.
+ */
+static void OS_BudgetListRemove(OS_TCBTypeDef *thread);
+#endif
 
 /**
  * @brief: Initializes a thread stack with default values to make it function correctly when scheduled for first time
@@ -35,12 +71,24 @@ static void OS_MapInitialThreadValues(OS_TCBTypeDef *thread, StackElementTypeDef
 static void OS_AddThread(OS_TCBTypeDef *thread);
 
 /**
- * @brief: Inserts an element in to a priority sorted linked list of threads
+ * @brief: Inserts an element in to a sorted linked list of threads
  * @param head: Pointer to the pointer of the first element of the linked list
  * @param tail: Pointer to the pointer of the last element of the linked list
  * @param element: Pointer to the TCB element that should be added
+ * @param insertsBefore: Ordering of the list, returns 1 if element belongs in front of other
  */
-static void OS_ThreadLinkedListInsert(OS_TCBTypeDef **head, OS_TCBTypeDef **tail, OS_TCBTypeDef *element);
+static void OS_ThreadLinkedListInsert(OS_TCBTypeDef **head, OS_TCBTypeDef **tail, OS_TCBTypeDef *element,
+                                      uint32_t (*insertsBefore)(const OS_TCBTypeDef *element, const OS_TCBTypeDef *other));
+
+/**
+ * @brief: Ordering of the ready and blocked lists, by priority and first in first out within a priority
+ */
+static uint32_t OS_PriorityOrder(const OS_TCBTypeDef *element, const OS_TCBTypeDef *other);
+
+/**
+ * @brief: Ordering of the sleep list, by wake up tick so that only the head needs to be checked every SysTick
+ */
+static uint32_t OS_WakeTickOrder(const OS_TCBTypeDef *element, const OS_TCBTypeDef *other);
 
 /**
  * @brief: Removes an element from the provided thread linked list
@@ -50,6 +98,11 @@ static void OS_ThreadLinkedListInsert(OS_TCBTypeDef **head, OS_TCBTypeDef **tail
  */
 static void OS_ThreadLinkedListRemove(OS_TCBTypeDef **head, OS_TCBTypeDef **tail, OS_TCBTypeDef *element);
 
+/**
+ * @brief: Euclid's algorithm, used for finding which periodic threads can ever be released on the same tick
+ */
+static uint32_t OS_GreatestCommonDivisor(uint32_t a, uint32_t b);
+
 
 /* ---------------------------------------------- Private variables ----------------------------------------------- */
 static OS_TCBTypeDef idleThreadAllocation = { 0 };
@@ -59,8 +112,30 @@ static OS_TCBTypeDef threadAllocations[NUM_USER_THREADS] = { 0 };
 // since it would otherwise mess up the next&prev pointers of the TCB. (Extra null element in list to make iterating easier)
 static OS_TCBTypeDef *periodicThreads[NUM_USER_THREADS+1] = { NULL };
 static OS_TCBTypeDef **periodicListPtr = periodicThreads;
-// Number of user threads created
+// Number of TCBs taken from threadAllocations, deleted threads are recycled through the free list after that
 static uint32_t threadsCreated = 0;
+static OS_TCBTypeDef *freeTCBListPtr = NULL;
+// Thread that deleted itself, it is freed by the scheduler once its context has been saved for the last time
+static OS_TCBTypeDef *zombiePtr = NULL;
+#if THREAD_STATS_ENABLED
+// Timestamp of the previous context switch, the running thread has been running since then
+static uint32_t lastSwitchTimestamp = 0;
+// Start of the current OS_GetCPULoad measurement window
+static uint32_t loadWindowStart = 0;
+static uint64_t loadWindowIdleTime = 0;
+#endif
+// Called when a stack overflow has been detected
+static OS_StackOverflowHookTypeDef stackOverflowHook = NULL;
+#if THREAD_BUDGET_ENABLED
+// Timestamp of the previous budget accounting, the running thread has not been charged for the time since then
+static uint32_t lastBudgetTimestamp = 0;
+// Called when a thread is throttled
+static OS_BudgetHookTypeDef budgetHook = NULL;
+// Threads with a budget, ordered by the end of their current window
+static OS_TCBTypeDef *budgetListPtr = NULL;
+#endif
+// Threads waiting in OS_JoinThread block on the semaphore matching the id of the thread being joined
+static OS_SemaphoreObjectTypeDef joinSemaphores[NUM_USER_THREADS];
 
 
 /* ----------------------------------------------- Global variables ----------------------------------------------- */
@@ -88,6 +163,19 @@ void OS_ResetThreads(void) {
     memset(threadAllocations, 0, sizeof(threadAllocations));
     memset(periodicThreads, 0, sizeof(periodicThreads));
     threadsCreated = 0;
+    freeTCBListPtr = NULL;
+    zombiePtr = NULL;
+    stackOverflowHook = NULL;
+#if THREAD_BUDGET_ENABLED
+    lastBudgetTimestamp = 0;
+    budgetHook = NULL;
+    budgetListPtr = NULL;
+#endif
+#if THREAD_STATS_ENABLED
+    lastSwitchTimestamp = 0;
+    loadWindowStart = 0;
+    loadWindowIdleTime = 0;
+#endif
     idlePtr = NULL;
     runPtr = NULL;
     readyHeadPtr = NULL;
@@ -155,12 +243,17 @@ static void OS_AddThread(OS_TCBTypeDef *thread) {
 }
 
 static void OS_InitializeTCBStack(OS_TCBTypeDef *thread, void (*function)(void *)) {
+    // Paint the whole stack, so that the deepest point ever reached can be found later
+    for (uint32_t i = 0; i < thread->stackSize; i++) {
+        thread->stackBase[i] = STACK_PAINT_PATTERN;
+    }
+
     // make stkPtr point to last element
     thread->stkPtr = &thread->stkPtr[thread->stackSize-1];
 
     *thread->stkPtr-- = 0x01000000;           // PSR
-    *thread->stkPtr-- = (uint32_t)function;   // Program counter
-    *thread->stkPtr-- = 0xFFFFFFF9;           // Link register
+    *thread->stkPtr-- = (uint32_t)(uintptr_t)function;   // Program counter
+    *thread->stkPtr-- = (uint32_t)(uintptr_t)&OS_ThreadExit; // Link register, returning from the thread function deletes it
     *thread->stkPtr-- = 0x12121212;           // R12
     *thread->stkPtr-- = 0x03030303;           // R3 ->
     *thread->stkPtr-- = 0x02020202;           // -
@@ -177,7 +270,15 @@ static void OS_InitializeTCBStack(OS_TCBTypeDef *thread, void (*function)(void *
 }
 
 static void OS_MapInitialThreadValues(OS_TCBTypeDef *thread, StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, const char *identifier, uint32_t period) {
+    // Recycled TCBs still hold the values of the deleted thread
+    uint8_t id = thread->id;
+    uint32_t generation = thread->generation;
+    memset(thread, 0, sizeof(OS_TCBTypeDef));
+    thread->id = id;
+    thread->generation = generation;
+
     thread->stkPtr = stkPtr;
+    thread->stackBase = stkPtr;
     thread->next = NULL;
     thread->prev = NULL;
     thread->stackSize = stackSize;
@@ -191,20 +292,49 @@ static void OS_MapInitialThreadValues(OS_TCBTypeDef *thread, StackElementTypeDef
 
     thread->priority = priority;
     thread->basePriority = priority;
-    thread->period = period;
     thread->basePeriod = period;
     thread->hasFullyRan = 1;
+    thread->state = DORMANT;
 }
 
 static void OS_ValidateTCB(uint32_t stackSize) {
-    // make sure we are not trying to create too many threads
-    assert(threadsCreated < NUM_USER_THREADS);
     // make sure stack can fit at least the initial stack frame
     assert(stackSize > 16);
 }
 
+static OS_TCBTypeDef *OS_AllocateTCB(void) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    OS_TCBTypeDef *thread = NULL;
+
+    if (threadsCreated < NUM_USER_THREADS) {
+        thread = &threadAllocations[threadsCreated];
+        thread->id = threadsCreated;
+        OS_InitSemaphore(&joinSemaphores[threadsCreated], SEMAPHORE_FLAG);
+        threadsCreated++;
+    } else if (freeTCBListPtr != NULL) {
+        thread = freeTCBListPtr;
+        freeTCBListPtr = thread->next;
+    }
+
+    OS_CRITICAL_EXIT(pri);
+    return thread;
+}
+
+static void OS_FreeTCB(OS_TCBTypeDef *thread) {
+    // Handles taken before this no longer match the TCB
+    thread->generation++;
+    if (thread->stackPool != NULL) {
+        // Also called by the scheduler when reaping, so the stack must be freed without suspending
+        OS_PoolFreeFromISR(thread->stackPool, thread->stackBase);
+        thread->stackPool = NULL;
+    }
+
+    thread->next = freeTCBListPtr;
+    freeTCBListPtr = thread;
+}
+
 static void OS_PeriodicListInsert(OS_TCBTypeDef *thread) {
-    for (uint32_t i = 0; i < threadsCreated; i++) {
+    for (uint32_t i = 0; i < NUM_USER_THREADS; i++) {
         if (periodicThreads[i] == NULL) {
             periodicThreads[i] = thread;
             return;
@@ -212,23 +342,148 @@ static void OS_PeriodicListInsert(OS_TCBTypeDef *thread) {
     }
 }
 
-void OS_CreateThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, const char *identifier) {
+static void OS_PeriodicListRemove(OS_TCBTypeDef *thread) {
+    for (uint32_t i = 0; periodicThreads[i] != NULL; i++) {
+        if (periodicThreads[i] == thread) {
+            // Shift the rest of the list down to keep it NULL terminated without holes
+            for (; periodicThreads[i] != NULL; i++) {
+                periodicThreads[i] = periodicThreads[i+1];
+            }
+            return;
+        }
+    }
+}
+
+OS_TCBTypeDef *OS_CreateThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, const char *identifier) {
     OS_ValidateTCB(stackSize);
-    OS_TCBTypeDef *newThread = &threadAllocations[threadsCreated];
+    OS_TCBTypeDef *newThread = OS_AllocateTCB();
+    if (newThread == NULL) {
+        return NULL;
+    }
+
     OS_MapInitialThreadValues(newThread, stkPtr, stackSize, priority, identifier, 0);
-    newThread->id = threadsCreated;
     OS_InitializeTCBStack(newThread, function);
     OS_AddThread(newThread);
-    threadsCreated++;
+    return newThread;
 }
 
-void OS_CreatePeriodicThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, uint32_t periodMillis, const char *identifier) {
+OS_TCBTypeDef *OS_CreateThreadFromPool(void (*function)(void *), OS_PoolTypeDef *stackPool, uint32_t priority, const char *identifier) {
+    OS_ValidateTCB(stackPool->blockSize / sizeof(StackElementTypeDef));
+    StackElementTypeDef *stkPtr = OS_PoolAlloc(stackPool);
+    if (stkPtr == NULL) {
+        return NULL;
+    }
+
+    OS_TCBTypeDef *newThread = OS_AllocateTCB();
+    if (newThread == NULL) {
+        OS_PoolFree(stackPool, stkPtr);
+        return NULL;
+    }
+
+    OS_MapInitialThreadValues(newThread, stkPtr, stackPool->blockSize / sizeof(StackElementTypeDef), priority, identifier, 0);
+    newThread->stackPool = stackPool;
+    OS_InitializeTCBStack(newThread, function);
+    OS_AddThread(newThread);
+    return newThread;
+}
+
+OS_TCBTypeDef *OS_CreatePeriodicThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, uint32_t periodMillis, const char *identifier) {
+    return OS_CreatePhasedPeriodicThread(function, stkPtr, stackSize, priority, periodMillis, 0, identifier);
+}
+
+OS_TCBTypeDef *OS_CreatePhasedPeriodicThread(void (*function)(void *), StackElementTypeDef *stkPtr, uint32_t stackSize, uint32_t priority, uint32_t periodMillis, uint32_t phaseMillis, const char *identifier) {
     OS_ValidateTCB(stackSize);
-    OS_TCBTypeDef *newThread = &threadAllocations[threadsCreated];
+    OS_TCBTypeDef *newThread = OS_AllocateTCB();
+    if (newThread == NULL) {
+        return NULL;
+    }
+
     OS_MapInitialThreadValues(newThread, stkPtr, stackSize, priority, identifier, periodMillis);
     OS_InitializeTCBStack(newThread, function);
-    threadsCreated++;
+    newThread->periodTicks = OS_MillisToTicks(periodMillis);
+    uint32_t pri = OS_CRITICAL_ENTER();
+    // Phase only shifts the grid, the first release is still one full period after it
+    uint32_t phaseTicks = phaseMillis / SYS_TICK_PERIOD_MILLIS;
+    newThread->nextRelease = OS_GetSysTickCount() + phaseTicks + newThread->periodTicks;
     OS_PeriodicListInsert(newThread);
+    OS_CRITICAL_EXIT(pri);
+    return newThread;
+}
+
+uint32_t OS_AssignPeriodicPhases(void) {
+    OS_TCBTypeDef *threads[NUM_USER_THREADS];
+    uint32_t periods[NUM_USER_THREADS];
+    uint32_t priorities[NUM_USER_THREADS];
+    uint32_t phases[NUM_USER_THREADS];
+    uint32_t gcds[NUM_USER_THREADS];
+    uint32_t count = 0;
+    uint32_t collisions = 0;
+
+    // Only the snapshot is taken with interrupts masked, the search itself can take a while
+    uint32_t pri = OS_CRITICAL_ENTER();
+    for (; periodicThreads[count] != NULL; count++) {
+        threads[count] = periodicThreads[count];
+        periods[count] = periodicThreads[count]->periodTicks;
+        priorities[count] = periodicThreads[count]->priority;
+    }
+    OS_CRITICAL_EXIT(pri);
+
+    // Sort by priority, so that the highest priority threads get the phases with the fewest collisions
+    for (uint32_t i = 1; i < count; i++) {
+        OS_TCBTypeDef *thread = threads[i];
+        uint32_t period = periods[i];
+        uint32_t priority = priorities[i];
+        uint32_t j = i;
+        for (; j > 0 && priorities[j-1] > priority; j--) {
+            threads[j] = threads[j-1];
+            periods[j] = periods[j-1];
+            priorities[j] = priorities[j-1];
+        }
+        threads[j] = thread;
+        periods[j] = period;
+        priorities[j] = priority;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t bestPhase = 0;
+        uint32_t bestCollisions = UINT32_MAX;
+
+        // Each pair is only needed while placing the later thread of it
+        for (uint32_t j = 0; j < i; j++) {
+            gcds[j] = OS_GreatestCommonDivisor(periods[i], periods[j]);
+        }
+
+        // Collisions only depend on the phase modulo the gcd with each placed thread, so one period covers everything
+        for (uint32_t phase = 0; phase < periods[i] && bestCollisions != 0; phase++) {
+            uint32_t phaseCollisions = 0;
+            for (uint32_t j = 0; j < i; j++) {
+                if ((phase % gcds[j]) == (phases[j] % gcds[j])) {
+                    phaseCollisions++;
+                }
+            }
+
+            if (phaseCollisions < bestCollisions) {
+                bestCollisions = phaseCollisions;
+                bestPhase = phase;
+            }
+        }
+
+        phases[i] = bestPhase;
+        collisions += bestCollisions;
+    }
+
+    // Rebase every thread on the same origin, so that the phases are relative to each other. Threads deleted or
+    // replaced while searching are left alone.
+    pri = OS_CRITICAL_ENTER();
+    uint64_t now = OS_GetSysTickCount();
+    for (uint32_t i = 0; i < count; i++) {
+        if (threads[i]->state != INACTIVE && threads[i]->periodTicks == periods[i]) {
+            threads[i]->nextRelease = now + phases[i] + periods[i];
+        }
+    }
+    OS_CRITICAL_EXIT(pri);
+
+    return collisions;
 }
 
 void OS_CreateIdleThread(void (*idleFunction)(void *), StackElementTypeDef *idleStkPtr, uint32_t stackSize) {
@@ -238,14 +493,394 @@ void OS_CreateIdleThread(void (*idleFunction)(void *), StackElementTypeDef *idle
     OS_TCBTypeDef *idleThread = &idleThreadAllocation;
     OS_MapInitialThreadValues(idleThread, idleStkPtr, stackSize, THREAD_MIN_PRIORITY + 1, "idle thread", 0);
     OS_InitializeTCBStack(idleThread, idleFunction);
+    idleThread->id = OS_IDLE_THREAD_ID;
     idlePtr = idleThread;
     // make the run pointer be the idle thread so that the first context switch works correctly
     runPtr = idleThread;
 }
 
 
+/* ----------------------------------------- Thread deletion functions -------------------------------------------- */
+static void OS_DetachThread(OS_TCBTypeDef *thread) {
+    // Release held mutexes first, OS_Signal may still re-sort the thread in its list when restoring its priority
+    while (thread->ownedMutexes != NULL) {
+        OS_Signal(thread->ownedMutexes);
+    }
+
+    switch (thread->state) {
+        case BLOCKED:
+            OS_CancelWaitUnlocked(thread);
+            break;
+        case ASLEEP:
+            OS_SleepListRemoveUnlocked(thread);
+            if (thread->waitObjects != NULL) {
+                OS_SelectListRemoveUnlocked(thread);
+                thread->waitObjects = NULL;
+            }
+            break;
+        case READY:
+            OS_ReadyListRemoveUnlocked(thread);
+            break;
+        default:
+            break;
+    }
+
+    if (thread->basePeriod != 0) {
+        OS_PeriodicListRemove(thread);
+    }
+
+    if (thread->tableDriven) {
+        OS_TableRemoveThreadUnlocked(thread);
+    }
+
+#if THREAD_BUDGET_ENABLED
+    if (thread->budget != 0) {
+        OS_BudgetListRemove(thread);
+    }
+#endif
+
+    thread->state = INACTIVE;
+
+    // Wake up every thread joining this one
+    while (joinSemaphores[thread->id].value < 0) {
+        OS_Signal(&joinSemaphores[thread->id]);
+    }
+}
+
+void OS_DeleteThread(OS_TCBTypeDef *thread) {
+    OS_DeleteThreadHandle(OS_GetThreadHandle(thread));
+}
+
+void OS_DeleteThreadHandle(OS_ThreadHandleTypeDef handle) {
+    OS_TCBTypeDef *thread = handle.thread;
+    // The idle thread has to always exist
+    assert(thread != idlePtr);
+
+    uint32_t pri = OS_CRITICAL_ENTER();
+    if (thread->generation != handle.generation || thread->state == INACTIVE) {
+        OS_CRITICAL_EXIT(pri);
+        return;
+    }
+
+    OS_DetachThread(thread);
+
+    if (thread == runPtr) {
+        // Still executing on its own stack, let the scheduler free it after the final context switch
+        zombiePtr = thread;
+        OS_CRITICAL_EXIT(pri);
+        OS_Suspend(OS_SUSPEND_BLOCK);
+        return;
+    }
+
+    OS_FreeTCB(thread);
+    OS_CRITICAL_EXIT(pri);
+    // Handing the stack back may have woken a higher priority thread waiting for one
+    OS_YieldIfPending();
+}
+
+void OS_ThreadExit(void) {
+    OS_DeleteThread(runPtr);
+    // Never scheduled again, the context switch happens as soon as the critical section has been exited
+    while (1);
+}
+
+void OS_JoinThread(OS_TCBTypeDef *thread) {
+    OS_JoinThreadHandle(OS_GetThreadHandle(thread));
+}
+
+void OS_JoinThreadHandle(OS_ThreadHandleTypeDef handle) {
+    OS_TCBTypeDef *thread = handle.thread;
+    uint32_t pri = OS_CRITICAL_ENTER();
+    if (thread->generation == handle.generation && thread->state != INACTIVE) {
+        OS_Wait(&joinSemaphores[thread->id]);
+    }
+    OS_CRITICAL_EXIT(pri);
+}
+
+OS_ThreadHandleTypeDef OS_GetThreadHandle(OS_TCBTypeDef *thread) {
+    OS_ThreadHandleTypeDef handle = { thread, thread->generation };
+    return handle;
+}
+
+void OS_ReapZombieThread(void) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    if (zombiePtr != NULL && zombiePtr != runPtr) {
+        OS_FreeTCB(zombiePtr);
+        zombiePtr = NULL;
+        // A thread waiting for the freed stack may now outrank the one just picked, switch again after this one
+        OS_YieldFromISR();
+    }
+    OS_CRITICAL_EXIT(pri);
+}
+
+
+/* -------------------------------------------- Stack usage functions --------------------------------------------- */
+void OS_SetStackOverflowHook(OS_StackOverflowHookTypeDef hook) {
+    stackOverflowHook = hook;
+}
+
+uint32_t OS_GetStackHighWater(OS_TCBTypeDef *thread) {
+    // Stacks grow downwards, count the elements that have never been written from the bottom up
+    uint32_t unused = 0;
+    while (unused < thread->stackSize && thread->stackBase[unused] == STACK_PAINT_PATTERN) {
+        unused++;
+    }
+
+    return thread->stackSize - unused;
+}
+
+void OS_CheckThreadStack(OS_TCBTypeDef *thread) {
+    // The canary only catches overflows that wrote over it, so check the saved stack pointer as well
+    if (thread->stackBase[0] != STACK_PAINT_PATTERN || thread->stkPtr < thread->stackBase) {
+        if (stackOverflowHook != NULL) {
+            stackOverflowHook(thread);
+        } else {
+            // Memory next to the stack has already been corrupted, nothing can be trusted anymore
+            assert(0);
+        }
+    }
+}
+
+
+/* ------------------------------------------ Thread statistics functions ----------------------------------------- */
+#if THREAD_STATS_ENABLED
+void OS_AccountContextSwitch(OS_TCBTypeDef *nextToRun, uint32_t voluntary) {
+    uint32_t now = BSP_GetTimestamp();
+    // Unsigned arithmetic keeps this correct when the timestamp rolls over
+    runPtr->runTime += now - lastSwitchTimestamp;
+    lastSwitchTimestamp = now;
+
+    if (nextToRun != runPtr) {
+        if (voluntary) {
+            runPtr->voluntarySwitches++;
+        } else {
+            runPtr->preemptiveSwitches++;
+        }
+
+        nextToRun->lastActivated = now;
+    }
+}
+
+static void OS_CopyThreadStats(OS_ThreadStatsTypeDef *stats, OS_TCBTypeDef *thread, uint32_t now) {
+    stats->identifier = thread->identifier;
+    stats->id = thread->id;
+    stats->priority = thread->priority;
+    stats->runTime = thread->runTime;
+    stats->voluntarySwitches = thread->voluntarySwitches;
+    stats->preemptiveSwitches = thread->preemptiveSwitches;
+    stats->lastActivated = thread->lastActivated;
+
+    // Include the ongoing time slice of the running thread
+    if (thread == runPtr) {
+        stats->runTime += now - lastSwitchTimestamp;
+    }
+}
+
+uint32_t OS_GetThreadStats(OS_ThreadStatsTypeDef *stats, uint32_t maxThreads) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    uint32_t now = BSP_GetTimestamp();
+    uint32_t count = 0;
+
+    if (count < maxThreads) {
+        OS_CopyThreadStats(&stats[count++], idlePtr, now);
+    }
+
+    for (uint32_t i = 0; i < threadsCreated && count < maxThreads; i++) {
+        if (threadAllocations[i].state != INACTIVE) {
+            OS_CopyThreadStats(&stats[count++], &threadAllocations[i], now);
+        }
+    }
+
+    OS_CRITICAL_EXIT(pri);
+    return count;
+}
+
+uint32_t OS_GetCPULoad(void) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    uint32_t now = BSP_GetTimestamp();
+
+    uint64_t idleTime = idlePtr->runTime;
+    if (runPtr == idlePtr) {
+        idleTime += now - lastSwitchTimestamp;
+    }
+
+    uint32_t elapsed = now - loadWindowStart;
+    uint64_t idleElapsed = idleTime - loadWindowIdleTime;
+    loadWindowStart = now;
+    loadWindowIdleTime = idleTime;
+
+    OS_CRITICAL_EXIT(pri);
+
+    if (elapsed == 0 || idleElapsed >= elapsed) {
+        return 0;
+    }
+
+    return 100 - (uint32_t)((idleElapsed * 100) / elapsed);
+}
+#endif
+
+
+/* ------------------------------------------ Wakeup latency functions -------------------------------------------- */
+#if WAKEUP_LATENCY_ENABLED
+void OS_RecordWakeupLatency(OS_TCBTypeDef *thread) {
+    if (!thread->wakeupPending) {
+        return;
+    }
+
+    thread->wakeupPending = 0;
+    uint32_t latency = BSP_GetTimestamp() - thread->readyTimestamp;
+    OS_LatencyStatsTypeDef *stats = &thread->wakeupLatency;
+
+    if (stats->count == 0 || latency < stats->min) {
+        stats->min = latency;
+    }
+    if (latency > stats->max) {
+        stats->max = latency;
+    }
+    stats->count++;
+    stats->histogram[OS_HistogramBucket(latency, WAKEUP_HISTOGRAM_BUCKETS)]++;
+}
+
+void OS_GetWakeupLatency(OS_TCBTypeDef *thread, OS_LatencyStatsTypeDef *stats) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    *stats = thread->wakeupLatency;
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_ResetWakeupLatency(OS_TCBTypeDef *thread) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    memset(&thread->wakeupLatency, 0, sizeof(thread->wakeupLatency));
+    OS_CRITICAL_EXIT(pri);
+}
+#endif
+
+
+/* -------------------------------------------- Thread budget functions ------------------------------------------- */
+#if THREAD_BUDGET_ENABLED
+void OS_SetThreadBudget(OS_TCBTypeDef *thread, uint32_t budgetMicros, uint32_t windowMillis) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    // Time used so far belongs to the previous owner of the budget
+    OS_AccountBudget();
+    if (thread->budget != 0) {
+        OS_BudgetListRemove(thread);
+    }
+
+    thread->budget = (uint32_t)OS_NsToCycles((uint64_t)budgetMicros * 1000u);
+    thread->budgetUsed = 0;
+    thread->budgetWindowTicks = OS_MillisToTicks(windowMillis);
+    thread->budgetWindowEnd = OS_GetSysTickCount() + thread->budgetWindowTicks;
+    thread->budgetThrottled = 0;
+
+    if (thread->budget != 0) {
+        OS_BudgetListInsert(thread);
+    }
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_SetBudgetHook(OS_BudgetHookTypeDef hook) {
+    budgetHook = hook;
+}
+
+uint32_t OS_AccountBudget(void) {
+    uint32_t now = BSP_GetTimestamp();
+    // Unsigned arithmetic keeps this correct when the timestamp rolls over
+    uint32_t elapsed = now - lastBudgetTimestamp;
+    lastBudgetTimestamp = now;
+
+    if (runPtr->budget == 0 || runPtr->budgetThrottled) {
+        return 0;
+    }
+
+    runPtr->budgetUsed += elapsed;
+    if (runPtr->budgetUsed < runPtr->budget) {
+        return 0;
+    }
+
+    runPtr->budgetThrottled = 1;
+    runPtr->budgetOverruns++;
+    if (budgetHook != NULL) {
+        budgetHook(runPtr);
+    }
+    return 1;
+}
+
+uint32_t OS_BudgetSysTick(uint64_t tickCount) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    uint32_t shouldRunScheduler = OS_AccountBudget();
+    OS_CRITICAL_EXIT(pri);
+
+    // The list is ordered by window end, so the loop stops at the first thread whose window is still running
+    while (1) {
+        pri = OS_CRITICAL_ENTER();
+        OS_TCBTypeDef *thread = budgetListPtr;
+        if (thread == NULL || thread->budgetWindowEnd > tickCount) {
+            OS_CRITICAL_EXIT(pri);
+            break;
+        }
+
+        OS_BudgetListRemove(thread);
+        // Windows stay on the grid, even if the SysTick fell behind
+        do {
+            thread->budgetWindowEnd += thread->budgetWindowTicks;
+        } while (thread->budgetWindowEnd <= tickCount);
+
+        thread->budgetUsed = 0;
+        if (thread->budgetThrottled) {
+            thread->budgetThrottled = 0;
+            shouldRunScheduler = 1;
+        }
+        OS_BudgetListInsert(thread);
+        OS_CRITICAL_EXIT(pri);
+    }
+
+    return shouldRunScheduler;
+}
+
+static void OS_BudgetListInsert(OS_TCBTypeDef *thread) {
+    // Threads whose windows end on the same tick are kept in the order they were inserted
+    OS_TCBTypeDef **listPtr = &budgetListPtr;
+    while (*listPtr != NULL && (*listPtr)->budgetWindowEnd <= thread->budgetWindowEnd) {
+        listPtr = &(*listPtr)->nextBudgeted;
+    }
+    thread->nextBudgeted = *listPtr;
+    *listPtr = thread;
+}
+
+static void OS_BudgetListRemove(OS_TCBTypeDef *thread) {
+    OS_TCBTypeDef **listPtr = &budgetListPtr;
+    while (*listPtr != NULL && *listPtr != thread) {
+        listPtr = &(*listPtr)->nextBudgeted;
+    }
+    if (*listPtr != NULL) {
+        *listPtr = thread->nextBudgeted;
+    }
+    thread->nextBudgeted = NULL;
+}
+#endif
+
+
 /* ------------------------------------- Thread list manipulation functions --------------------------------------- */
-static void OS_ThreadLinkedListInsert(OS_TCBTypeDef **head, OS_TCBTypeDef **tail, OS_TCBTypeDef *element) {
+static uint32_t OS_PriorityOrder(const OS_TCBTypeDef *element, const OS_TCBTypeDef *other) {
+    return element->priority < other->priority;
+}
+
+static uint32_t OS_WakeTickOrder(const OS_TCBTypeDef *element, const OS_TCBTypeDef *other) {
+    // Threads waking up on the same tick are kept in priority order
+    return element->wakeTick < other->wakeTick ||
+           (element->wakeTick == other->wakeTick && element->priority < other->priority);
+}
+
+static uint32_t OS_GreatestCommonDivisor(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t tmp = a % b;
+        a = b;
+        b = tmp;
+    }
+    return a;
+}
+
+static void OS_ThreadLinkedListInsert(OS_TCBTypeDef **head, OS_TCBTypeDef **tail, OS_TCBTypeDef *element,
+                                      uint32_t (*insertsBefore)(const OS_TCBTypeDef *element, const OS_TCBTypeDef *other)) {
     assert(element != NULL);
 
     if (*head == NULL) {
@@ -256,8 +891,8 @@ static void OS_ThreadLinkedListInsert(OS_TCBTypeDef **head, OS_TCBTypeDef **tail
 
     OS_TCBTypeDef *tmpPtr = *head;
     while(tmpPtr != NULL) {
-        // Find the first thread with lower priority than new thread, and insert the new thread in front of it
-        if (element->priority < tmpPtr->priority) {
+        // Find the first thread that orders after the new thread, and insert the new thread in front of it
+        if (insertsBefore(element, tmpPtr)) {
             // if current pointer is head of the list
             if (tmpPtr->prev == NULL) {
                 *head = element;
@@ -276,7 +911,7 @@ static void OS_ThreadLinkedListInsert(OS_TCBTypeDef **head, OS_TCBTypeDef **tail
         tmpPtr = tmpPtr->next;
     }
 
-    // If this point is reached, the new thread is lower priority than anything in the list, so we make it the new tail
+    // If this point is reached, the new thread orders after anything in the list, so we make it the new tail
     (*tail)->next = element;
     element->prev = *tail;
     *tail = element;
@@ -314,40 +949,77 @@ static void OS_ThreadLinkedListRemove(OS_TCBTypeDef **head, OS_TCBTypeDef **tail
 
 
 /* --------------------------- Exported function wrappers for thread list manipulation ---------------------------- */
+void OS_ReadyListInsertUnlocked(OS_TCBTypeDef *thread) {
+#if WAKEUP_LATENCY_ENABLED
+    // The running thread is only re-sorted after a priority change, and a pending thread keeps its original stamp
+    if (thread != runPtr && !thread->wakeupPending) {
+        thread->wakeupPending = 1;
+        thread->readyTimestamp = BSP_GetTimestamp();
+    }
+#endif
+    OS_ThreadLinkedListInsert(&readyHeadPtr, &readyTailPtr, thread, &OS_PriorityOrder);
+    thread->state = READY;
+}
+
+void OS_ReadyListRemoveUnlocked(OS_TCBTypeDef *thread) {
+    OS_ThreadLinkedListRemove(&readyHeadPtr, &readyTailPtr, thread);
+    thread->state = DORMANT;
+}
+
+void OS_SleepListInsertUnlocked(OS_TCBTypeDef *thread) {
+    OS_ThreadLinkedListInsert(&sleepHeadPtr, &sleepTailPtr, thread, &OS_WakeTickOrder);
+    thread->state = ASLEEP;
+}
+
+void OS_SleepListRemoveUnlocked(OS_TCBTypeDef *thread) {
+    OS_ThreadLinkedListRemove(&sleepHeadPtr, &sleepTailPtr, thread);
+    thread->state = DORMANT;
+}
+
+void OS_BlockedListInsertUnlocked(OS_TCBTypeDef *thread) {
+    OS_ThreadLinkedListInsert(&blockHeadPtr, &blockTailPtr, thread, &OS_PriorityOrder);
+    thread->state = BLOCKED;
+}
+
+void OS_BlockedListRemoveUnlocked(OS_TCBTypeDef *thread) {
+    OS_ThreadLinkedListRemove(&blockHeadPtr, &blockTailPtr, thread);
+    thread->state = DORMANT;
+}
+
 void OS_ReadyListInsert(OS_TCBTypeDef *thread) {
-    uint32_t priority = OS_CriticalEnter();
-    OS_ThreadLinkedListInsert(&readyHeadPtr, &readyTailPtr, thread);
-    OS_CriticalExit(priority);
+    uint32_t priority = OS_CRITICAL_ENTER();
+    OS_ReadyListInsertUnlocked(thread);
+    OS_CRITICAL_EXIT(priority);
 }
 
 void OS_ReadyListRemove(OS_TCBTypeDef *thread) {
-    uint32_t priority = OS_CriticalEnter();
-    OS_ThreadLinkedListRemove(&readyHeadPtr, &readyTailPtr, thread);
-    OS_CriticalExit(priority);
+    uint32_t priority = OS_CRITICAL_ENTER();
+    OS_ReadyListRemoveUnlocked(thread);
+    OS_CRITICAL_EXIT(priority);
 }
 
 void OS_SleepListInsert(OS_TCBTypeDef *thread) {
-    uint32_t priority = OS_CriticalEnter();
-    OS_ThreadLinkedListInsert(&sleepHeadPtr, &sleepTailPtr, thread);
-    OS_CriticalExit(priority);
+    uint32_t priority = OS_CRITICAL_ENTER();
+    OS_SleepListInsertUnlocked(thread);
+    OS_CRITICAL_EXIT(priority);
 }
 
 void OS_SleepListRemove(OS_TCBTypeDef *thread) {
-    uint32_t priority = OS_CriticalEnter();
-    OS_ThreadLinkedListRemove(&sleepHeadPtr, &sleepTailPtr, thread);
-    OS_CriticalExit(priority);
+    uint32_t priority = OS_CRITICAL_ENTER();
+    OS_SleepListRemoveUnlocked(thread);
+    OS_CRITICAL_EXIT(priority);
 }
 
 void OS_BlockedListInsert(OS_TCBTypeDef *thread) {
-    uint32_t priority = OS_CriticalEnter();
-    OS_ThreadLinkedListInsert(&blockHeadPtr, &blockTailPtr, thread);
-    OS_CriticalExit(priority);
+    uint32_t priority = OS_CRITICAL_ENTER();
+    OS_BlockedListInsertUnlocked(thread);
+    OS_CRITICAL_EXIT(priority);
 }
 
 void OS_BlockedListRemove(OS_TCBTypeDef *thread) {
-    uint32_t priority = OS_CriticalEnter();
-    OS_ThreadLinkedListRemove(&blockHeadPtr, &blockTailPtr, thread);
-    OS_CriticalExit(priority);
+    uint32_t priority = OS_CRITICAL_ENTER();
+    OS_BlockedListRemoveUnlocked(thread);
+    OS_CRITICAL_EXIT(priority);
 }
 
 OS_TCBTypeDef **getPeriodicListPtr(void) {
@@ -0,0 +1,194 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "stddef.h"
+#include "os_timer.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "bsp.h"
+#include "os_critical.h"
+
+
+/* ----------------------------------------------- Global variables ----------------------------------------------- */
+OS_TimerServiceTypeDef osTimerService;
+
+
+/* --------------------------------------------- Private variables ----------------------------------------------- */
+static StackElementTypeDef timerDaemonStack[TIMER_DAEMON_STACK_SIZE];
+
+
+/* ---------------------------------------- Private function declarations ----------------------------------------- */
+/**
+ * @brief: Thread function of the daemon, sleeps on the semaphore until a timer expires
+ */
+static void timerDaemon(void *ptr);
+
+/**
+ * @brief: Inserts the timer to the active list behind every timer expiring on the same tick or before it. Must be
+ *         called inside a critical section.
+ */
+static void timerListInsert(OS_TimerTypeDef *timer);
+
+/**
+ * @brief: Removes the timer from the active list, must be called inside a critical section
+ */
+static void timerListRemove(OS_TimerTypeDef *timer);
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+uint32_t OS_TimerServiceInit(void) {
+    osTimerService.head = NULL;
+    osTimerService.tail = NULL;
+    osTimerService.overruns = 0;
+    OS_InitSemaphore(&osTimerService.semaphore, SEMAPHORE_FLAG);
+
+    return OS_CreateThread(&timerDaemon, timerDaemonStack, TIMER_DAEMON_STACK_SIZE, TIMER_DAEMON_PRIORITY,
+                           "timer daemon") != NULL;
+}
+
+void OS_TimerCreate(OS_TimerTypeDef *timer, OS_TimerCallbackTypeDef callback, void *arg, uint32_t periodMillis,
+                    uint32_t autoReload) {
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->periodTicks = OS_MillisToTicks(periodMillis);
+    timer->autoReload = autoReload;
+    timer->active = 0;
+    timer->expiryTick = 0;
+    timer->next = NULL;
+    timer->prev = NULL;
+}
+
+void OS_TimerStart(OS_TimerTypeDef *timer) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    uint32_t pri = OS_CRITICAL_ENTER();
+    if (!timer->active) {
+        timer->expiryTick = OS_GetSysTickCount() + timer->periodTicks;
+        timerListInsert(timer);
+    }
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_TimerStop(OS_TimerTypeDef *timer) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    uint32_t pri = OS_CRITICAL_ENTER();
+    if (timer->active) {
+        timerListRemove(timer);
+    }
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_TimerReset(OS_TimerTypeDef *timer) {
+    OS_ASSERT_SYSCALL_PRIORITY();
+    uint32_t pri = OS_CRITICAL_ENTER();
+    if (timer->active) {
+        timerListRemove(timer);
+    }
+    timer->expiryTick = OS_GetSysTickCount() + timer->periodTicks;
+    timerListInsert(timer);
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_TimerChangePeriod(OS_TimerTypeDef *timer, uint32_t periodMillis) {
+    uint32_t pri = OS_CRITICAL_ENTER();
+    timer->periodTicks = OS_MillisToTicks(periodMillis);
+    OS_TimerReset(timer);
+    OS_CRITICAL_EXIT(pri);
+}
+
+void OS_TimerSysTick(uint64_t tickCount) {
+    // A thread may be relinking the list, and the 64 bit expiry tick is written with two stores
+    uint32_t pri = OS_CRITICAL_ENTER();
+    // Flag semaphore saturates, so signaling again before the daemon has caught up costs nothing
+    if (osTimerService.head != NULL && osTimerService.head->expiryTick <= tickCount) {
+        OS_SignalFromISR(&osTimerService.semaphore);
+    }
+    OS_CRITICAL_EXIT(pri);
+}
+
+uint32_t OS_TimerRunExpired(void) {
+    uint32_t ran = 0;
+
+    while (1) {
+        uint32_t pri = OS_CRITICAL_ENTER();
+        uint64_t now = OS_GetSysTickCount();
+        OS_TimerTypeDef *timer = osTimerService.head;
+        if (timer == NULL || timer->expiryTick > now) {
+            OS_CRITICAL_EXIT(pri);
+            break;
+        }
+
+        timerListRemove(timer);
+        // Restart before the callback, so that the callback is free to stop or reset its own timer
+        if (timer->autoReload) {
+            // Keep the period relative to the previous expiry so that the timer does not drift, skip any periods
+            // that were missed entirely
+            timer->expiryTick += timer->periodTicks;
+            while (timer->expiryTick <= now) {
+                timer->expiryTick += timer->periodTicks;
+                osTimerService.overruns++;
+            }
+            timerListInsert(timer);
+        }
+        OS_TimerCallbackTypeDef callback = timer->callback;
+        void *arg = timer->arg;
+        OS_CRITICAL_EXIT(pri);
+
+        callback(arg);
+        ran++;
+    }
+
+    return ran;
+}
+
+static void timerDaemon(void *ptr) {
+    (void)ptr;
+    while (1) {
+        OS_Wait(&osTimerService.semaphore);
+        OS_TimerRunExpired();
+    }
+}
+
+static void timerListInsert(OS_TimerTypeDef *timer) {
+    timer->active = 1;
+    OS_TimerTypeDef *tmpPtr = osTimerService.tail;
+
+    // Timers are mostly started with the same period they ran with, so search from the back of the list
+    while (tmpPtr != NULL && tmpPtr->expiryTick > timer->expiryTick) {
+        tmpPtr = tmpPtr->prev;
+    }
+
+    timer->prev = tmpPtr;
+    if (tmpPtr == NULL) {
+        timer->next = osTimerService.head;
+        osTimerService.head = timer;
+    } else {
+        timer->next = tmpPtr->next;
+        tmpPtr->next = timer;
+    }
+
+    if (timer->next == NULL) {
+        osTimerService.tail = timer;
+    } else {
+        timer->next->prev = timer;
+    }
+}
+
+static void timerListRemove(OS_TimerTypeDef *timer) {
+    if (timer->prev == NULL) {
+        osTimerService.head = timer->next;
+    } else {
+        timer->prev->next = timer->next;
+    }
+
+    if (timer->next == NULL) {
+        osTimerService.tail = timer->prev;
+    } else {
+        timer->next->prev = timer->prev;
+    }
+
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->active = 0;
+}
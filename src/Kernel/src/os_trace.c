@@ -0,0 +1,46 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+
+#include "os_trace.h"
+#include "bsp.h"
+
+#if TRACE_ENABLED
+
+#if (TRACE_BUFFER_RECORDS & (TRACE_BUFFER_RECORDS - 1)) != 0
+#error "TRACE_BUFFER_RECORDS must be a power of two"
+#endif
+
+
+/* ----------------------------------------------- Global variables ----------------------------------------------- */
+OS_TraceBufferTypeDef osTraceBuffer = {
+    .magic = TRACE_MAGIC,
+    .recordSize = sizeof(OS_TraceRecordTypeDef),
+    .capacity = TRACE_BUFFER_RECORDS,
+    .writeCount = 0
+};
+
+
+/* -------------------------------------------- Function definitions ---------------------------------------------- */
+void OS_TraceRecord(uint8_t event, uint8_t threadId, uint32_t object) {
+    uint32_t pri = OS_CriticalEnter();
+
+    OS_TraceRecordTypeDef *record = &osTraceBuffer.records[osTraceBuffer.writeCount & (TRACE_BUFFER_RECORDS - 1)];
+    record->timestamp = BSP_GetTimestamp();
+    record->object = object;
+    record->event = event;
+    record->threadId = threadId;
+    record->reserved = 0;
+    osTraceBuffer.writeCount++;
+
+    OS_CriticalExit(pri);
+}
+
+void OS_TraceReset(void) {
+    uint32_t pri = OS_CriticalEnter();
+    osTraceBuffer.writeCount = 0;
+    OS_CriticalExit(pri);
+}
+
+#endif
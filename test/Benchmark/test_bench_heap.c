@@ -0,0 +1,87 @@
+#include "unity.h"
+#include <stdlib.h>
+
+#include "mrtos_config.h"
+#include "os_heap.h"
+#include "mock_bsp.h"
+#include "bench_timer.h"
+
+#define BENCH_HEAP_SIZE (256*1024)
+#define BENCH_SLOTS 256
+#define BENCH_MAX_ALLOC 2048
+#define BENCH_OPERATIONS 200000
+
+static uint8_t benchMemory[BENCH_HEAP_SIZE];
+static void *liveBlocks[BENCH_SLOTS];
+
+static uint32_t samples[4][BENCH_OPERATIONS];
+
+void setUp(void) {
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+}
+
+void tearDown(void) {
+}
+
+void test_BenchmarkHeapAgainstMalloc(void) {
+    OS_HeapTypeDef heap;
+    OS_HeapInit(&heap, benchMemory, BENCH_HEAP_SIZE);
+    BenchStatsTypeDef heapAlloc = {samples[0], BENCH_OPERATIONS, 0, 0};
+    BenchStatsTypeDef heapFree = {samples[1], BENCH_OPERATIONS, 0, 0};
+    BenchStatsTypeDef mallocAlloc = {samples[2], BENCH_OPERATIONS, 0, 0};
+    BenchStatsTypeDef mallocFree = {samples[3], BENCH_OPERATIONS, 0, 0};
+
+    // Same random sequence of sizes, allocations and frees in random slots for both allocators
+    for (int allocator = 0; allocator < 2; allocator++) {
+        srand(1234);
+        for (uint32_t i = 0; i < BENCH_OPERATIONS; i++) {
+            uint32_t slot = (uint32_t)rand() % BENCH_SLOTS;
+            uint32_t size = 1 + (uint32_t)rand() % BENCH_MAX_ALLOC;
+            uint64_t start = benchTimestamp();
+            if (liveBlocks[slot] == NULL) {
+                liveBlocks[slot] = allocator ? malloc(size) : OS_HeapAlloc(&heap, size);
+                benchRecord(allocator ? &mallocAlloc : &heapAlloc, benchTimestamp() - start);
+            } else {
+                if (allocator) {
+                    free(liveBlocks[slot]);
+                } else {
+                    OS_HeapFree(&heap, liveBlocks[slot]);
+                }
+                benchRecord(allocator ? &mallocFree : &heapFree, benchTimestamp() - start);
+                liveBlocks[slot] = NULL;
+            }
+        }
+
+        if (!allocator) {
+            TEST_ASSERT_TRUE(OS_HeapCheck(&heap));
+            OS_HeapStatsTypeDef stats;
+            OS_HeapGetStats(&heap, &stats);
+            printf("OS_Heap: peak %lu/%lu bytes, %lu free blocks, %lu%% fragmented, %lu failed\n",
+                   (unsigned long)stats.peakUsedBytes, (unsigned long)stats.totalBytes,
+                   (unsigned long)stats.freeBlocks, (unsigned long)stats.fragmentationPercent,
+                   (unsigned long)stats.failed);
+        }
+
+        for (uint32_t slot = 0; slot < BENCH_SLOTS; slot++) {
+            if (liveBlocks[slot] != NULL) {
+                if (allocator) {
+                    free(liveBlocks[slot]);
+                } else {
+                    OS_HeapFree(&heap, liveBlocks[slot]);
+                }
+                liveBlocks[slot] = NULL;
+            }
+        }
+    }
+
+    benchReport("OS_HeapAlloc", &heapAlloc);
+    benchReport("malloc", &mallocAlloc);
+    benchReport("OS_HeapFree", &heapFree);
+    benchReport("free", &mallocFree);
+
+    TEST_ASSERT_EQUAL_INT(0, heap.allocations);
+    TEST_ASSERT_EQUAL_INT(0, heap.failed);
+    TEST_ASSERT_TRUE(OS_HeapCheck(&heap));
+}
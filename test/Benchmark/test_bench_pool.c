@@ -0,0 +1,75 @@
+#include "unity.h"
+#include <stdlib.h>
+
+#include "mrtos_config.h"
+#include "os_pool.h"
+#include "mock_bsp.h"
+#include "bench_timer.h"
+
+#define BENCH_BLOCK_SIZE 48
+#define BENCH_BLOCKS 64
+#define BENCH_OPERATIONS 200000
+
+static OS_POOL_DECLARE(benchStorage, BENCH_BLOCK_SIZE, BENCH_BLOCKS);
+static void *liveBlocks[BENCH_BLOCKS];
+
+static uint32_t samples[4][BENCH_OPERATIONS];
+
+void setUp(void) {
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    srand(1234);
+}
+
+void tearDown(void) {
+}
+
+void test_BenchmarkPoolAgainstMalloc(void) {
+    OS_PoolTypeDef pool;
+    OS_PoolInit(&pool, benchStorage, OS_POOL_BLOCK_SIZE(BENCH_BLOCK_SIZE), BENCH_BLOCKS);
+    BenchStatsTypeDef poolAlloc = {samples[0], BENCH_OPERATIONS, 0, 0};
+    BenchStatsTypeDef poolFree = {samples[1], BENCH_OPERATIONS, 0, 0};
+    BenchStatsTypeDef mallocAlloc = {samples[2], BENCH_OPERATIONS, 0, 0};
+    BenchStatsTypeDef mallocFree = {samples[3], BENCH_OPERATIONS, 0, 0};
+
+    // Same random sequence of allocations and frees in random slots for both allocators
+    for (int allocator = 0; allocator < 2; allocator++) {
+        srand(1234);
+        for (uint32_t i = 0; i < BENCH_OPERATIONS; i++) {
+            uint32_t slot = (uint32_t)rand() % BENCH_BLOCKS;
+            uint64_t start = benchTimestamp();
+            if (liveBlocks[slot] == NULL) {
+                liveBlocks[slot] = allocator ? malloc(BENCH_BLOCK_SIZE) : OS_PoolAlloc(&pool);
+                benchRecord(allocator ? &mallocAlloc : &poolAlloc, benchTimestamp() - start);
+            } else {
+                if (allocator) {
+                    free(liveBlocks[slot]);
+                } else {
+                    OS_PoolFree(&pool, liveBlocks[slot]);
+                }
+                benchRecord(allocator ? &mallocFree : &poolFree, benchTimestamp() - start);
+                liveBlocks[slot] = NULL;
+            }
+        }
+
+        for (uint32_t slot = 0; slot < BENCH_BLOCKS; slot++) {
+            if (liveBlocks[slot] != NULL) {
+                if (allocator) {
+                    free(liveBlocks[slot]);
+                } else {
+                    OS_PoolFree(&pool, liveBlocks[slot]);
+                }
+                liveBlocks[slot] = NULL;
+            }
+        }
+    }
+
+    benchReport("OS_PoolAlloc", &poolAlloc);
+    benchReport("malloc", &mallocAlloc);
+    benchReport("OS_PoolFree", &poolFree);
+    benchReport("free", &mallocFree);
+
+    TEST_ASSERT_EQUAL_INT(0, pool.inUse);
+    TEST_ASSERT_EQUAL_INT(0, pool.failed);
+}
@@ -0,0 +1,107 @@
+#include "unity.h"
+#include <stdio.h>
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_buffers.h"
+#include "os_ring.h"
+#include "mock_bsp.h"
+#include "bench_timer.h"
+
+#define BENCH_ELEMENTS 64
+#define BENCH_ROUNDS 2000
+
+OS_RING_DEFINE(BenchRing, uint16_t, BENCH_ELEMENTS)
+
+static void idleFn(void *ptr) {}
+static void testFn(void *ptr) {}
+
+static uint16_t bufferStorage[BENCH_ELEMENTS];
+static uint16_t samples[BENCH_ELEMENTS];
+static uint16_t readBack[BENCH_ELEMENTS];
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+
+    for (uint16_t i = 0; i < BENCH_ELEMENTS; i++) {
+        samples[i] = i;
+    }
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+static void report(const char *name, uint64_t elapsed) {
+    printf("%-40s %8.2f %s/element\n", name, (double)elapsed / (BENCH_ROUNDS * BENCH_ELEMENTS), BENCH_UNIT);
+}
+
+void test_BenchmarkSingleElementAccess(void) {
+    StackElementTypeDef testStack[20];
+    OS_CreateThread(&testFn, testStack, 20, 3, "bench thread");
+    runPtr = OS_GetReadyThreadByIdentifier("bench thread");
+
+    OS_BufferTypeDef buffer;
+    OS_BufferInit(&buffer, bufferStorage, BENCH_ELEMENTS, sizeof(uint16_t));
+    uint64_t start = benchTimestamp();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint32_t i = 0; i < BENCH_ELEMENTS; i++) {
+            OS_BufferWrite(&buffer, &samples[i], 1);
+        }
+        for (uint32_t i = 0; i < BENCH_ELEMENTS; i++) {
+            OS_BufferRead(&buffer, &readBack[i], 1);
+        }
+    }
+    report("OS_Buffer, 1 element per call", benchTimestamp() - start);
+    TEST_ASSERT_EQUAL_MEMORY(samples, readBack, sizeof(samples));
+
+    BenchRingTypeDef ring;
+    BenchRingInit(&ring);
+    start = benchTimestamp();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint32_t i = 0; i < BENCH_ELEMENTS; i++) {
+            BenchRingPut(&ring, samples[i]);
+        }
+        for (uint32_t i = 0; i < BENCH_ELEMENTS; i++) {
+            BenchRingGet(&ring, &readBack[i]);
+        }
+    }
+    report("OS_RING_DEFINE, 1 element per call", benchTimestamp() - start);
+    TEST_ASSERT_EQUAL_MEMORY(samples, readBack, sizeof(samples));
+}
+
+void test_BenchmarkBlockAccess(void) {
+    StackElementTypeDef testStack[20];
+    OS_CreateThread(&testFn, testStack, 20, 3, "bench thread");
+    runPtr = OS_GetReadyThreadByIdentifier("bench thread");
+
+    OS_BufferTypeDef buffer;
+    OS_BufferInit(&buffer, bufferStorage, BENCH_ELEMENTS, sizeof(uint16_t));
+    uint64_t start = benchTimestamp();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        OS_BufferWrite(&buffer, samples, BENCH_ELEMENTS);
+        OS_BufferRead(&buffer, readBack, BENCH_ELEMENTS);
+    }
+    report("OS_Buffer, block per call", benchTimestamp() - start);
+    TEST_ASSERT_EQUAL_MEMORY(samples, readBack, sizeof(samples));
+
+    BenchRingTypeDef ring;
+    BenchRingInit(&ring);
+    start = benchTimestamp();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        BenchRingWrite(&ring, samples, BENCH_ELEMENTS);
+        BenchRingRead(&ring, readBack, BENCH_ELEMENTS);
+    }
+    report("OS_RING_DEFINE, block per call", benchTimestamp() - start);
+    TEST_ASSERT_EQUAL_MEMORY(samples, readBack, sizeof(samples));
+}
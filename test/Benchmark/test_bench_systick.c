@@ -0,0 +1,97 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_scheduling.h"
+#include "mock_bsp.h"
+#include "bench_timer.h"
+
+#define BENCH_TICKS 100000
+#define BENCH_SLEEPERS (NUM_USER_THREADS - 1)
+
+static void idleFn(void *ptr) {}
+static void testFn(void *ptr) {}
+
+static uint32_t samples[BENCH_TICKS];
+static uint32_t maskedSamples[BENCH_TICKS];
+static StackElementTypeDef stacks[NUM_USER_THREADS][40];
+
+// Models PRIMASK, so that only the outermost critical section is timed as interrupts being disabled
+static uint32_t primask = 0;
+static uint64_t maskedStart = 0;
+static uint64_t longestMasked = 0;
+
+static uint32_t criticalEnterStub(int numCalls) {
+    uint32_t previous = primask;
+    if (!previous) {
+        maskedStart = benchTimestamp();
+    }
+    primask = 1;
+    return previous;
+}
+
+static void criticalExitStub(uint32_t previous, int numCalls) {
+    primask = previous;
+    if (!previous) {
+        uint64_t masked = benchTimestamp() - maskedStart;
+        if (masked > longestMasked) {
+            longestMasked = masked;
+        }
+    }
+}
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_StubWithCallback(&criticalEnterStub);
+    OS_CriticalExit_StubWithCallback(&criticalExitStub);
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+    BSP_TriggerPendSV_Ignore();
+
+    static StackElementTypeDef idleStack[40];
+    OS_Init(&idleFn, idleStack, 40);
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+void test_BenchmarkSysTickWithSleepingThreads(void) {
+    OS_TCBTypeDef *running = OS_CreateThread(&testFn, stacks[0], 40, 1, "running");
+    OS_TCBTypeDef *sleepers[BENCH_SLEEPERS];
+    for (int i = 0; i < BENCH_SLEEPERS; i++) {
+        sleepers[i] = OS_CreateThread(&testFn, stacks[i+1], 40, 2, "sleeper");
+    }
+
+    // Every sleeper sleeps for a different amount of ticks, and goes back to sleep right after waking up
+    BenchStatsTypeDef sysTick = {samples, BENCH_TICKS, 0, 0};
+    BenchStatsTypeDef masked = {maskedSamples, BENCH_TICKS, 0, 0};
+    for (int i = 0; i < BENCH_SLEEPERS; i++) {
+        runPtr = sleepers[i];
+        OS_Sleep((uint32_t)(50 + i*7) * SYS_TICK_PERIOD_MILLIS);
+    }
+
+    for (uint32_t tick = 0; tick < BENCH_TICKS; tick++) {
+        runPtr = running;
+        longestMasked = 0;
+        uint64_t start = benchTimestamp();
+        SysTick_Handler();
+        benchRecord(&sysTick, benchTimestamp() - start);
+        // Longest stretch of the tick spent with interrupts disabled
+        benchRecord(&masked, longestMasked);
+
+        for (int i = 0; i < BENCH_SLEEPERS; i++) {
+            if (OS_GetReadyThreadByIdentifier("sleeper") == sleepers[i]) {
+                runPtr = sleepers[i];
+                OS_Sleep((uint32_t)(50 + i*7) * SYS_TICK_PERIOD_MILLIS);
+            }
+        }
+    }
+
+    benchReport("SysTick_Handler", &sysTick);
+    benchReport("Interrupts disabled", &masked);
+    TEST_ASSERT_EQUAL_INT(BENCH_TICKS, OS_GetSysTickCount());
+}
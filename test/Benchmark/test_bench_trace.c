@@ -0,0 +1,30 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_trace.h"
+#include "mock_bsp.h"
+#include "bench_timer.h"
+
+#define BENCH_EVENTS 100000
+
+void setUp(void) {
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+    OS_TraceReset();
+}
+
+void tearDown(void) {
+}
+
+void test_BenchmarkTraceRecord(void) {
+    uint64_t start = benchTimestamp();
+    for (uint32_t i = 0; i < BENCH_EVENTS; i++) {
+        OS_TraceRecord(TRACE_EVENT_USER, 1, i);
+    }
+    uint64_t elapsed = benchTimestamp() - start;
+
+    printf("OS_TraceRecord           %.1f %s per event\n", (double)elapsed / BENCH_EVENTS, BENCH_UNIT);
+    TEST_ASSERT_EQUAL_INT(BENCH_EVENTS, osTraceBuffer.writeCount);
+}
@@ -0,0 +1,172 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_broadcast.h"
+#include "mock_bsp.h"
+
+static void idleFn(void *ptr) {}
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+void test_EveryReaderGetsTheSameData(void) {
+    uint32_t data[10] = {0};
+    OS_BroadcastTypeDef channel;
+    OS_BroadcastInit(&channel, data, 10, sizeof(uint32_t));
+
+    OS_BroadcastReaderTypeDef reader1;
+    OS_BroadcastReaderTypeDef reader2;
+    OS_BroadcastSubscribe(&channel, &reader1);
+    OS_BroadcastSubscribe(&channel, &reader2);
+
+    uint32_t writeData[5] = {1, 2, 3, 4, 5};
+    OS_BroadcastWrite(&channel, writeData, 5);
+
+    uint32_t readData1[5] = {0};
+    uint32_t readData2[5] = {0};
+    OS_BroadcastRead(&reader1, readData1, 5);
+    OS_BroadcastRead(&reader2, readData2, 5);
+
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_INT(writeData[i], readData1[i]);
+        TEST_ASSERT_EQUAL_INT(writeData[i], readData2[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(5, reader1.lastReadSize);
+    TEST_ASSERT_EQUAL_INT(5, reader2.lastReadSize);
+}
+
+void test_ReadersHaveIndependentCursors(void) {
+    uint32_t data[10] = {0};
+    OS_BroadcastTypeDef channel;
+    OS_BroadcastInit(&channel, data, 10, sizeof(uint32_t));
+
+    OS_BroadcastReaderTypeDef reader1;
+    OS_BroadcastReaderTypeDef reader2;
+    OS_BroadcastSubscribe(&channel, &reader1);
+    OS_BroadcastSubscribe(&channel, &reader2);
+
+    uint32_t writeData[6] = {1, 2, 3, 4, 5, 6};
+    OS_BroadcastWrite(&channel, writeData, 6);
+
+    uint32_t readData[6] = {0};
+    OS_BroadcastRead(&reader1, readData, 4);
+    OS_BroadcastRead(&reader1, readData, 4);
+    TEST_ASSERT_EQUAL_INT(2, reader1.lastReadSize);
+    TEST_ASSERT_EQUAL_INT(5, readData[0]);
+    TEST_ASSERT_EQUAL_INT(6, readData[1]);
+
+    OS_BroadcastRead(&reader2, readData, 6);
+    TEST_ASSERT_EQUAL_INT(6, reader2.lastReadSize);
+    TEST_ASSERT_EQUAL_INT(1, readData[0]);
+    TEST_ASSERT_EQUAL_INT(6, readData[5]);
+}
+
+void test_ReaderSubscribingLateOnlySeesNewData(void) {
+    uint32_t data[10] = {0};
+    OS_BroadcastTypeDef channel;
+    OS_BroadcastInit(&channel, data, 10, sizeof(uint32_t));
+
+    uint32_t writeData1[3] = {1, 2, 3};
+    OS_BroadcastWrite(&channel, writeData1, 3);
+
+    OS_BroadcastReaderTypeDef reader;
+    OS_BroadcastSubscribe(&channel, &reader);
+
+    uint32_t readData[3] = {0};
+    OS_BroadcastRead(&reader, readData, 3);
+    TEST_ASSERT_EQUAL_INT(0, reader.lastReadSize);
+
+    uint32_t writeData2[1] = {4};
+    OS_BroadcastWrite(&channel, writeData2, 1);
+    OS_BroadcastRead(&reader, readData, 3);
+    TEST_ASSERT_EQUAL_INT(1, reader.lastReadSize);
+    TEST_ASSERT_EQUAL_INT(4, readData[0]);
+}
+
+void test_SlowReaderOnlyMissesItsOwnData(void) {
+    uint32_t data[4] = {0};
+    OS_BroadcastTypeDef channel;
+    OS_BroadcastInit(&channel, data, 4, sizeof(uint32_t));
+
+    OS_BroadcastReaderTypeDef fastReader;
+    OS_BroadcastReaderTypeDef slowReader;
+    OS_BroadcastSubscribe(&channel, &fastReader);
+    OS_BroadcastSubscribe(&channel, &slowReader);
+
+    uint32_t readData[4] = {0};
+    for (uint32_t i = 0; i < 6; i++) {
+        OS_BroadcastWrite(&channel, &i, 1);
+        OS_BroadcastRead(&fastReader, readData, 4);
+        TEST_ASSERT_EQUAL_INT(i, readData[0]);
+    }
+
+    OS_BroadcastRead(&slowReader, readData, 4);
+    TEST_ASSERT_EQUAL_INT(4, slowReader.lastReadSize);
+    TEST_ASSERT_EQUAL_INT(2, slowReader.missed);
+    TEST_ASSERT_EQUAL_INT(0, fastReader.missed);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(i+2, readData[i]);
+    }
+}
+
+void test_WriteRollsOver(void) {
+    uint8_t data[5] = {0};
+    OS_BroadcastTypeDef channel;
+    OS_BroadcastInit(&channel, data, 5, sizeof(uint8_t));
+
+    OS_BroadcastReaderTypeDef reader;
+    OS_BroadcastSubscribe(&channel, &reader);
+
+    uint8_t writeData1[3] = {1, 2, 3};
+    OS_BroadcastWrite(&channel, writeData1, 3);
+    uint8_t readData[5] = {0};
+    OS_BroadcastRead(&reader, readData, 5);
+
+    uint8_t writeData2[4] = {4, 5, 6, 7};
+    OS_BroadcastWrite(&channel, writeData2, 4);
+    TEST_ASSERT_EQUAL_INT(6, data[0]);
+    TEST_ASSERT_EQUAL_INT(7, data[1]);
+    TEST_ASSERT_EQUAL_INT(3, data[2]);
+    TEST_ASSERT_EQUAL_INT(4, data[3]);
+
+    OS_BroadcastRead(&reader, readData, 5);
+    TEST_ASSERT_EQUAL_INT(4, reader.lastReadSize);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(writeData2[i], readData[i]);
+    }
+}
+
+void test_WriteLargerThanChannelKeepsNewestData(void) {
+    uint32_t data[3] = {0};
+    OS_BroadcastTypeDef channel;
+    OS_BroadcastInit(&channel, data, 3, sizeof(uint32_t));
+
+    OS_BroadcastReaderTypeDef reader;
+    OS_BroadcastSubscribe(&channel, &reader);
+
+    uint32_t writeData[5] = {1, 2, 3, 4, 5};
+    OS_BroadcastWrite(&channel, writeData, 5);
+
+    uint32_t readData[3] = {0};
+    OS_BroadcastRead(&reader, readData, 3);
+    TEST_ASSERT_EQUAL_INT(2, reader.missed);
+    TEST_ASSERT_EQUAL_INT(3, readData[0]);
+    TEST_ASSERT_EQUAL_INT(4, readData[1]);
+    TEST_ASSERT_EQUAL_INT(5, readData[2]);
+}
@@ -20,8 +20,10 @@ void setUp(void) {
     BSP_HardwareInit_Ignore();
     OS_CriticalEnter_IgnoreAndReturn(1);
     OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
 
-    StackElementTypeDef idleStack[20];
+    static StackElementTypeDef idleStack[20];
     OS_Init(&idleFn, idleStack, 20);
 }
 
@@ -176,3 +178,26 @@ void test_NotEnoughData(void) {
     TEST_ASSERT_EQUAL_INT(10, testBuffer.spaceRemaining);
     TEST_ASSERT_EQUAL_INT(4, testBuffer.lastReadSize);
 }
+
+void test_BufferReadsFromReadIndex(void) {
+    uint32_t data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    OS_BufferTypeDef testBuffer;
+    OS_BufferInit(&testBuffer, &data, 10, sizeof(uint32_t));
+    testBuffer.spaceRemaining = 2;
+    testBuffer.readIndex = 2;
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20,3, "test thread1");
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+
+    uint32_t readData[3] = {0};
+    OS_BufferRead(&testBuffer, readData, 3);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(data[i+2], readData[i]);
+    }
+
+    TEST_ASSERT_EQUAL_INT(5, testBuffer.readIndex);
+    TEST_ASSERT_EQUAL_INT(5, testBuffer.spaceRemaining);
+}
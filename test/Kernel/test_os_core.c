@@ -0,0 +1,72 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "mock_bsp.h"
+
+static void idleFn(void *ptr) {}
+
+static uint32_t tickDuringRead(int numCalls) {
+    // SysTick fires between reading the count and the timer, the timer has already wrapped
+    if (numCalls == 0) {
+        SysTick_Handler();
+        return 3;
+    }
+    return 5;
+}
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+    BSP_TriggerPendSV_Ignore();
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+void test_TimeCyclesCombinesTicksAndTimer(void) {
+    for (int i = 0; i < 3; i++) {
+        SysTick_Handler();
+    }
+
+    BSP_GetTickTimerElapsed_ExpectAndReturn(500);
+    BSP_IsTickPending_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL_INT(OS_GetSysTickCount()*OS_CYCLES_PER_TICK + 500, OS_GetTimeCycles());
+}
+
+void test_PendingTickIsCountedBeforeItIsServiced(void) {
+    // Timer wrapped while the SysTick was masked, the first read may be from either side of the wrap
+    uint64_t ticks = OS_GetSysTickCount();
+    BSP_GetTickTimerElapsed_ExpectAndReturn(OS_CYCLES_PER_TICK - 1);
+    BSP_IsTickPending_ExpectAndReturn(1);
+    BSP_GetTickTimerElapsed_ExpectAndReturn(20);
+    TEST_ASSERT_EQUAL_INT((ticks + 1)*OS_CYCLES_PER_TICK + 20, OS_GetTimeCycles());
+}
+
+void test_TimeReadIsRetriedIfSysTickRuns(void) {
+    uint64_t ticks = OS_GetSysTickCount();
+    BSP_GetTickTimerElapsed_StubWithCallback(&tickDuringRead);
+    BSP_IsTickPending_IgnoreAndReturn(0);
+
+    TEST_ASSERT_EQUAL_INT((ticks + 1)*OS_CYCLES_PER_TICK + 5, OS_GetTimeCycles());
+}
+
+void test_TimeConversions(void) {
+    TEST_ASSERT_EQUAL_INT(1000, OS_CyclesToNs(SYSCLOCK_FREQUENCY));
+    TEST_ASSERT_EQUAL_INT(SYSCLOCK_FREQUENCY, OS_NsToCycles(1000));
+    TEST_ASSERT_EQUAL_INT(1000, OS_CyclesToMicros(OS_CYCLES_PER_TICK / SYS_TICK_PERIOD_MILLIS));
+
+    BSP_GetTickTimerElapsed_IgnoreAndReturn(SYSCLOCK_FREQUENCY);
+    BSP_IsTickPending_IgnoreAndReturn(0);
+    TEST_ASSERT_EQUAL_INT(OS_CyclesToNs(OS_GetSysTickCount()*OS_CYCLES_PER_TICK) + 1000, OS_GetTimeNs());
+}
@@ -0,0 +1,80 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_critical.h"
+#include "mock_bsp.h"
+
+void setUp(void) {
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+    OS_CriticalProfileReset();
+}
+
+void tearDown(void) {
+}
+
+static void criticalSectionAtSite(uint32_t line, uint32_t start, uint32_t end) {
+    BSP_GetTimestamp_IgnoreAndReturn(start);
+    uint32_t pri = OS_CriticalProfiledEnter("os_test.c", line);
+    BSP_GetTimestamp_IgnoreAndReturn(end);
+    OS_CriticalProfiledExit(pri);
+}
+
+void test_CriticalSectionsAreRecordedPerSite(void) {
+    criticalSectionAtSite(10, 100, 105);
+    criticalSectionAtSite(10, 200, 300);
+    criticalSectionAtSite(20, 0xFFFFFFF0, 0x10);
+
+    const OS_CriticalSiteTypeDef *worst = OS_CriticalGetWorstSite();
+    TEST_ASSERT_EQUAL_INT(10, worst->line);
+    TEST_ASSERT_EQUAL_INT(2, worst->count);
+    TEST_ASSERT_EQUAL_INT(100, worst->maxDuration);
+    // 5 ticks lands in [4, 8), 100 ticks in [64, 128)
+    TEST_ASSERT_EQUAL_INT(1, worst->histogram[3]);
+    TEST_ASSERT_EQUAL_INT(1, worst->histogram[7]);
+    TEST_ASSERT_EQUAL_INT(0, osCriticalProfile.depth);
+}
+
+void test_NestedCriticalSectionsCountAsOuterSection(void) {
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+    uint32_t outer = OS_CriticalProfiledEnter("os_test.c", 10);
+    BSP_GetTimestamp_IgnoreAndReturn(50);
+    uint32_t inner = OS_CriticalProfiledEnter("os_test.c", 20);
+    BSP_GetTimestamp_IgnoreAndReturn(60);
+    OS_CriticalProfiledExit(inner);
+    TEST_ASSERT_NULL(OS_CriticalGetWorstSite());
+
+    BSP_GetTimestamp_IgnoreAndReturn(80);
+    OS_CriticalProfiledExit(outer);
+
+    const OS_CriticalSiteTypeDef *worst = OS_CriticalGetWorstSite();
+    TEST_ASSERT_EQUAL_INT(10, worst->line);
+    TEST_ASSERT_EQUAL_INT(80, worst->maxDuration);
+    TEST_ASSERT_EQUAL_INT(2, osCriticalProfile.maxDepth);
+}
+
+void test_CriticalSitesBeyondTableAreDropped(void) {
+    for (uint32_t line = 1; line <= CRITICAL_PROFILING_SITES + 2; line++) {
+        criticalSectionAtSite(line, 0, line);
+    }
+
+    TEST_ASSERT_EQUAL_INT(2, osCriticalProfile.droppedSections);
+    TEST_ASSERT_EQUAL_INT(CRITICAL_PROFILING_SITES, OS_CriticalGetWorstSite()->maxDuration);
+}
+
+void test_SyscallGuardFiresAboveThreshold(void) {
+    osSyscallPriorityViolations = 0;
+
+    // Numerically lower is more urgent, an ISR at the threshold or below it may call the kernel
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(MAX_SYSCALL_INTERRUPT_PRIORITY);
+    OS_ASSERT_SYSCALL_PRIORITY();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    OS_ASSERT_SYSCALL_PRIORITY();
+    TEST_ASSERT_EQUAL_INT(0, osSyscallPriorityViolations);
+
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0x20);
+    OS_ASSERT_SYSCALL_PRIORITY();
+    TEST_ASSERT_EQUAL_INT(1, osSyscallPriorityViolations);
+}
@@ -0,0 +1,132 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_semaphore.h"
+#include "os_scheduling.h"
+#include "os_defer.h"
+#include "mock_bsp.h"
+
+#define EXPECT_SCHEDULER() BSP_TriggerPendSV_Expect()
+#define EXPECT_BLOCKED() BSP_TriggerPendSV_Expect()
+
+static void idleFn(void *ptr) {}
+
+static uint32_t callOrder[DEFER_QUEUE_LENGTH + 1];
+static uint32_t callCount;
+
+static void recordCall(void *arg) {
+    callOrder[callCount++] = (uint32_t)(uintptr_t)arg;
+}
+
+static void deferAnother(void *arg) {
+    recordCall(arg);
+    OS_DeferCall(&recordCall, (void *)99);
+}
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+    callCount = 0;
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+void test_DeferredCallsRunInOrderAsOneBatch(void) {
+    TEST_ASSERT_EQUAL_INT(1, OS_DeferInit());
+    // Worker is the only thread created
+    OS_TCBTypeDef *worker = readyHeadPtr;
+    TEST_ASSERT_EQUAL_STRING("defer worker", worker->identifier);
+    TEST_ASSERT_EQUAL_INT(DEFER_WORKER_PRIORITY, worker->priority);
+
+    // Worker has found the queue empty and waits for the semaphore
+    runPtr = worker;
+    EXPECT_BLOCKED();
+    OS_Wait(&osDeferQueue.semaphore);
+    runPtr = idlePtr;
+
+    // ISR defers three calls, the worker is woken once they are all queued
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0x60);
+    for (uint32_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(1, OS_DeferCall(&recordCall, (void *)(uintptr_t)i));
+    }
+    TEST_ASSERT_EQUAL_INT(0, callCount);
+    EXPECT_SCHEDULER();
+    OS_YieldFromISR();
+    TEST_ASSERT_EQUAL_PTR(worker, readyHeadPtr);
+
+    TEST_ASSERT_EQUAL_INT(3, OS_DeferRunPending());
+    TEST_ASSERT_EQUAL_INT(0, callOrder[0]);
+    TEST_ASSERT_EQUAL_INT(1, callOrder[1]);
+    TEST_ASSERT_EQUAL_INT(2, callOrder[2]);
+    TEST_ASSERT_EQUAL_INT(3, osDeferQueue.highWater);
+    TEST_ASSERT_EQUAL_INT(0, OS_DeferRunPending());
+}
+
+void test_CallDeferredFromThreadSwitchesToWorker(void) {
+    OS_DeferInit();
+    OS_TCBTypeDef *worker = readyHeadPtr;
+    runPtr = worker;
+    EXPECT_BLOCKED();
+    OS_Wait(&osDeferQueue.semaphore);
+
+    StackElementTypeDef testStack[20];
+    OS_TCBTypeDef *caller = OS_CreateThread(&idleFn, testStack, 20, DEFER_WORKER_PRIORITY + 1, "test thread");
+    runPtr = caller;
+
+    // No ISR is going to call OS_YieldFromISR, so the call itself switches to the higher priority worker
+    EXPECT_SCHEDULER();
+    TEST_ASSERT_EQUAL_INT(1, OS_DeferCall(&recordCall, (void *)1));
+    TEST_ASSERT_EQUAL_PTR(worker, readyHeadPtr);
+
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(worker, runPtr);
+    TEST_ASSERT_EQUAL_INT(1, caller->voluntarySwitches);
+    TEST_ASSERT_EQUAL_INT(0, caller->preemptiveSwitches);
+}
+
+void test_FullQueueDropsCall(void) {
+    OS_DeferInit();
+
+    for (uint32_t i = 0; i < DEFER_QUEUE_LENGTH; i++) {
+        TEST_ASSERT_EQUAL_INT(1, OS_DeferCall(&recordCall, (void *)(uintptr_t)i));
+    }
+    TEST_ASSERT_EQUAL_INT(0, OS_DeferCall(&recordCall, (void *)0));
+    TEST_ASSERT_EQUAL_INT(1, osDeferQueue.dropped);
+
+    TEST_ASSERT_EQUAL_INT(DEFER_QUEUE_LENGTH, OS_DeferRunPending());
+    TEST_ASSERT_EQUAL_INT(DEFER_QUEUE_LENGTH - 1, callOrder[DEFER_QUEUE_LENGTH - 1]);
+}
+
+void test_CallCanDeferAnotherCall(void) {
+    OS_DeferInit();
+
+    OS_DeferCall(&deferAnother, (void *)1);
+    TEST_ASSERT_EQUAL_INT(2, OS_DeferRunPending());
+    TEST_ASSERT_EQUAL_INT(1, callOrder[0]);
+    TEST_ASSERT_EQUAL_INT(99, callOrder[1]);
+}
+
+void test_ReservedSlotHoldsBackLaterCalls(void) {
+    OS_DeferInit();
+
+    OS_DeferCall(&recordCall, (void *)1);
+    OS_DeferCall(&recordCall, (void *)2);
+    // Pretend the ISR that reserved the first slot was interrupted before it finished filling it
+    osDeferQueue.calls[0].ready = 0;
+    TEST_ASSERT_EQUAL_INT(0, OS_DeferRunPending());
+
+    osDeferQueue.calls[0].ready = 1;
+    TEST_ASSERT_EQUAL_INT(2, OS_DeferRunPending());
+}
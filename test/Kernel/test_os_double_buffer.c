@@ -0,0 +1,118 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_semaphore.h"
+#include "os_scheduling.h"
+#include "os_double_buffer.h"
+#include "mock_bsp.h"
+
+#define EXPECT_SCHEDULER() BSP_TriggerPendSV_Expect()
+#define EXPECT_BLOCKED() BSP_TriggerPendSV_Expect()
+
+#define HALF_SIZE OS_DOUBLE_BUFFER_HALF_SIZE(40)
+
+static void idleFn(void *ptr) {}
+static void testFn(void *ptr) {}
+
+static OS_DOUBLE_BUFFER_DECLARE(testStorage, 40);
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+void test_StorageIsAlignedAndPadded(void) {
+    TEST_ASSERT_EQUAL_INT(0, (uintptr_t)testStorage % DOUBLE_BUFFER_ALIGNMENT);
+    TEST_ASSERT_EQUAL_INT(0, HALF_SIZE % DOUBLE_BUFFER_ALIGNMENT);
+    TEST_ASSERT_TRUE(HALF_SIZE >= 40);
+}
+
+void test_SwapHandsCompletedHalfToConsumer(void) {
+    OS_DoubleBufferTypeDef doubleBuffer;
+    OS_DoubleBufferInit(&doubleBuffer, testStorage, HALF_SIZE);
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+
+    TEST_ASSERT_EQUAL_PTR(&testStorage[0], OS_DoubleBufferDMATarget(&doubleBuffer));
+    TEST_ASSERT_EQUAL_PTR(&testStorage[HALF_SIZE], OS_DoubleBufferSwap(&doubleBuffer));
+    TEST_ASSERT_EQUAL_PTR(&testStorage[0], OS_DoubleBufferAcquire(&doubleBuffer));
+    OS_DoubleBufferRelease(&doubleBuffer);
+
+    TEST_ASSERT_EQUAL_PTR(&testStorage[0], OS_DoubleBufferSwap(&doubleBuffer));
+    TEST_ASSERT_EQUAL_PTR(&testStorage[HALF_SIZE], OS_DoubleBufferAcquire(&doubleBuffer));
+    TEST_ASSERT_EQUAL_INT(0, doubleBuffer.overruns);
+}
+
+void test_AcquireBlocksUntilSwap(void) {
+    OS_DoubleBufferTypeDef doubleBuffer;
+    OS_DoubleBufferInit(&doubleBuffer, testStorage, HALF_SIZE);
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+
+    // Acquire would carry on once woken, so only do the blocking part of it here
+    EXPECT_BLOCKED();
+    OS_Wait(&doubleBuffer.semaphore);
+    TEST_ASSERT_NOT_NULL(OS_GetBlockedThreadByIdentifier("test thread1"));
+
+    // Swap from an ISR interrupting the idle thread wakes the higher priority consumer
+    runPtr = idlePtr;
+    OS_DoubleBufferSwap(&doubleBuffer);
+    TEST_ASSERT_NOT_NULL(OS_GetReadyThreadByIdentifier("test thread1"));
+    EXPECT_SCHEDULER();
+    OS_YieldFromISR();
+}
+
+void test_SwapWhileConsumerHoldsHalfIsOverrun(void) {
+    OS_DoubleBufferTypeDef doubleBuffer;
+    OS_DoubleBufferInit(&doubleBuffer, testStorage, HALF_SIZE);
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+
+    OS_DoubleBufferSwap(&doubleBuffer);
+    uint8_t *half = OS_DoubleBufferAcquire(&doubleBuffer);
+
+    // DMA completes the other half, but the consumer still holds its half, so DMA has to refill the same half
+    TEST_ASSERT_EQUAL_PTR(&testStorage[HALF_SIZE], OS_DoubleBufferSwap(&doubleBuffer));
+    TEST_ASSERT_EQUAL_INT(1, doubleBuffer.overruns);
+    TEST_ASSERT_EQUAL_PTR(&testStorage[0], half);
+
+    OS_DoubleBufferRelease(&doubleBuffer);
+    TEST_ASSERT_EQUAL_PTR(&testStorage[0], OS_DoubleBufferSwap(&doubleBuffer));
+    TEST_ASSERT_EQUAL_INT(1, doubleBuffer.overruns);
+}
+
+void test_SwapBeforeAcquireIsOverrun(void) {
+    OS_DoubleBufferTypeDef doubleBuffer;
+    OS_DoubleBufferInit(&doubleBuffer, testStorage, HALF_SIZE);
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+
+    OS_DoubleBufferSwap(&doubleBuffer);
+    TEST_ASSERT_EQUAL_PTR(&testStorage[HALF_SIZE], OS_DoubleBufferSwap(&doubleBuffer));
+    TEST_ASSERT_EQUAL_INT(1, doubleBuffer.overruns);
+
+    // The consumer still gets the first completed half, which has not been touched by the DMA since
+    TEST_ASSERT_EQUAL_PTR(&testStorage[0], OS_DoubleBufferAcquire(&doubleBuffer));
+}
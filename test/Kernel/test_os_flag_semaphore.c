@@ -19,8 +19,10 @@ void setUp(void) {
     BSP_HardwareInit_Ignore();
     OS_CriticalEnter_IgnoreAndReturn(1);
     OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
 
-    StackElementTypeDef idleStack[20];
+    static StackElementTypeDef idleStack[20];
     OS_Init(&idleFn, idleStack, 20);
 }
 
@@ -66,6 +68,47 @@ void test_FlagSemaphoreUnBlocks(void) {
     TEST_ASSERT_EQUAL_INT(0, testSemaphore.value);
 }
 
+void test_SignalsFromOneISRCauseSingleReschedule(void) {
+    OS_SemaphoreObjectTypeDef testSemaphore0;
+    OS_InitSemaphore(&testSemaphore0, SEMAPHORE_FLAG);
+    OS_SemaphoreObjectTypeDef testSemaphore1;
+    OS_InitSemaphore(&testSemaphore1, SEMAPHORE_FLAG);
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_CreateThread(&testFn, testStack2, 20, 2, "test thread2");
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+    EXPECT_BLOCKED();
+    OS_Wait(&testSemaphore0);
+    runPtr = OS_GetReadyThreadByIdentifier("test thread2");
+    EXPECT_BLOCKED();
+    OS_Wait(&testSemaphore1);
+
+    // ISR interrupting the idle thread wakes both threads, the switch only happens when the ISR yields
+    runPtr = idlePtr;
+    OS_SignalFromISR(&testSemaphore0);
+    OS_SignalFromISR(&testSemaphore1);
+    TEST_ASSERT_NOT_NULL(OS_GetReadyThreadByIdentifier("test thread1"));
+    TEST_ASSERT_NOT_NULL(OS_GetReadyThreadByIdentifier("test thread2"));
+
+    EXPECT_SCHEDULER();
+    OS_YieldFromISR();
+    // Nothing left pending for the next interrupt
+    OS_YieldFromISR();
+}
+
+void test_SignalFromISRWithoutWakeupDoesNotReschedule(void) {
+    OS_SemaphoreObjectTypeDef testSemaphore;
+    OS_InitSemaphore(&testSemaphore, SEMAPHORE_FLAG);
+
+    runPtr = idlePtr;
+    OS_SignalFromISR(&testSemaphore);
+    OS_YieldFromISR();
+    TEST_ASSERT_EQUAL_INT(1, testSemaphore.value);
+}
+
 void test_FlagSemaphoreSignalNoOneWaiting(void) {
     OS_SemaphoreObjectTypeDef testSemaphore;
     OS_InitSemaphore(&testSemaphore, SEMAPHORE_FLAG);
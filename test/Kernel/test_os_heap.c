@@ -0,0 +1,125 @@
+#include "unity.h"
+#include <string.h>
+
+#include "mrtos_config.h"
+#include "os_heap.h"
+#include "mock_bsp.h"
+
+static uint8_t heapMemory[4096];
+
+void setUp(void) {
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+}
+
+void tearDown(void) {
+}
+
+void test_HeapAllocatesAlignedDistinctMemory(void) {
+    OS_HeapTypeDef heap;
+    OS_HeapInit(&heap, heapMemory + 1, sizeof(heapMemory) - 1);
+
+    uint8_t *ptr1 = OS_HeapAlloc(&heap, 10);
+    uint8_t *ptr2 = OS_HeapAlloc(&heap, 100);
+    TEST_ASSERT_NOT_NULL(ptr1);
+    TEST_ASSERT_NOT_NULL(ptr2);
+    TEST_ASSERT_EQUAL_INT(0, (uintptr_t)ptr1 % HEAP_ALIGN_SIZE);
+    TEST_ASSERT_EQUAL_INT(0, (uintptr_t)ptr2 % HEAP_ALIGN_SIZE);
+    TEST_ASSERT_TRUE(ptr1 + 10 <= ptr2 || ptr2 + 100 <= ptr1);
+
+    memset(ptr1, 0xAA, 10);
+    memset(ptr2, 0x55, 100);
+    TEST_ASSERT_TRUE(OS_HeapCheck(&heap));
+    TEST_ASSERT_EQUAL_INT(2, heap.allocations);
+}
+
+void test_HeapFailsWhenExhausted(void) {
+    OS_HeapTypeDef heap;
+    OS_HeapInit(&heap, heapMemory, sizeof(heapMemory));
+
+    TEST_ASSERT_NULL(OS_HeapAlloc(&heap, sizeof(heapMemory)));
+    TEST_ASSERT_NULL(OS_HeapAlloc(&heap, 0));
+    TEST_ASSERT_EQUAL_INT(2, heap.failed);
+    TEST_ASSERT_NOT_NULL(OS_HeapAlloc(&heap, 1024));
+    TEST_ASSERT_TRUE(OS_HeapCheck(&heap));
+}
+
+void test_HeapFreeCoalescesNeighbours(void) {
+    OS_HeapTypeDef heap;
+    OS_HeapInit(&heap, heapMemory, sizeof(heapMemory));
+    OS_HeapStatsTypeDef initial;
+    OS_HeapGetStats(&heap, &initial);
+
+    void *ptrs[3];
+    for (int i = 0; i < 3; i++) {
+        ptrs[i] = OS_HeapAlloc(&heap, 1000);
+    }
+    // Not enough room for another 1000 bytes until the freed neighbours are merged back together
+    TEST_ASSERT_NULL(OS_HeapAlloc(&heap, 1500));
+
+    OS_HeapFree(&heap, ptrs[0]);
+    OS_HeapFree(&heap, ptrs[2]);
+    TEST_ASSERT_TRUE(OS_HeapCheck(&heap));
+    TEST_ASSERT_NULL(OS_HeapAlloc(&heap, 2000));
+
+    OS_HeapFree(&heap, ptrs[1]);
+    TEST_ASSERT_TRUE(OS_HeapCheck(&heap));
+
+    OS_HeapStatsTypeDef stats;
+    OS_HeapGetStats(&heap, &stats);
+    TEST_ASSERT_EQUAL_INT(1, stats.freeBlocks);
+    TEST_ASSERT_EQUAL_INT(initial.largestFreeBlock, stats.largestFreeBlock);
+    TEST_ASSERT_EQUAL_INT(0, stats.usedBytes);
+    TEST_ASSERT_NOT_NULL(OS_HeapAlloc(&heap, 3000));
+}
+
+void test_HeapStatsTrackPeakAndFragmentation(void) {
+    OS_HeapTypeDef heap;
+    OS_HeapInit(&heap, heapMemory, sizeof(heapMemory));
+
+    void *ptrs[8];
+    for (int i = 0; i < 8; i++) {
+        ptrs[i] = OS_HeapAlloc(&heap, 256);
+    }
+    for (int i = 0; i < 8; i += 2) {
+        OS_HeapFree(&heap, ptrs[i]);
+    }
+
+    OS_HeapStatsTypeDef stats;
+    OS_HeapGetStats(&heap, &stats);
+    TEST_ASSERT_EQUAL_INT(4, stats.allocations);
+    TEST_ASSERT_TRUE(stats.peakUsedBytes >= 8*256);
+    TEST_ASSERT_TRUE(stats.usedBytes < stats.peakUsedBytes);
+    TEST_ASSERT_EQUAL_INT(stats.totalBytes - stats.usedBytes, stats.freeBytes);
+    TEST_ASSERT_EQUAL_INT(5, stats.freeBlocks);
+    TEST_ASSERT_TRUE(stats.fragmentationPercent > 0);
+    TEST_ASSERT_TRUE(stats.fragmentationPercent < 100);
+}
+
+void test_HeapSurvivesRandomAllocations(void) {
+    OS_HeapTypeDef heap;
+    OS_HeapInit(&heap, heapMemory, sizeof(heapMemory));
+
+    void *ptrs[16] = {0};
+    uint32_t seed = 1;
+    for (int i = 0; i < 2000; i++) {
+        seed = seed*1103515245 + 12345;
+        uint32_t slot = (seed >> 16) % 16;
+        if (ptrs[slot] == NULL) {
+            ptrs[slot] = OS_HeapAlloc(&heap, 1 + ((seed >> 8) % 300));
+        } else {
+            OS_HeapFree(&heap, ptrs[slot]);
+            ptrs[slot] = NULL;
+        }
+        TEST_ASSERT_TRUE(OS_HeapCheck(&heap));
+    }
+
+    for (int i = 0; i < 16; i++) {
+        OS_HeapFree(&heap, ptrs[i]);
+    }
+    OS_HeapStatsTypeDef stats;
+    OS_HeapGetStats(&heap, &stats);
+    TEST_ASSERT_EQUAL_INT(1, stats.freeBlocks);
+    TEST_ASSERT_EQUAL_INT(0, stats.fragmentationPercent);
+}
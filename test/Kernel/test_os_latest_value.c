@@ -0,0 +1,81 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_latest_value.h"
+
+typedef struct {
+    int32_t position;
+    int16_t velocity;
+    uint8_t flags;
+} TestStateTypeDef;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_ReadBeforeWriteReturnsInitialValue(void) {
+    TestStateTypeDef storage[2] = {{1, 2, 3}, {0}};
+    OS_LatestValueTypeDef latest;
+    OS_LatestValueInit(&latest, storage, sizeof(TestStateTypeDef));
+
+    TestStateTypeDef readState = {0};
+    TEST_ASSERT_EQUAL_INT(0, OS_LatestValueRead(&latest, &readState));
+    TEST_ASSERT_EQUAL_INT(1, readState.position);
+    TEST_ASSERT_EQUAL_INT(2, readState.velocity);
+    TEST_ASSERT_EQUAL_INT(3, readState.flags);
+}
+
+void test_ReadReturnsLatestWrite(void) {
+    TestStateTypeDef storage[2] = {0};
+    OS_LatestValueTypeDef latest;
+    OS_LatestValueInit(&latest, storage, sizeof(TestStateTypeDef));
+
+    TestStateTypeDef writeState = {0};
+    TestStateTypeDef readState = {0};
+    for (int32_t i = 1; i <= 5; i++) {
+        writeState.position = i*100;
+        writeState.velocity = (int16_t)-i;
+        OS_LatestValueWrite(&latest, &writeState);
+
+        TEST_ASSERT_EQUAL_INT(i, OS_LatestValueRead(&latest, &readState));
+        TEST_ASSERT_EQUAL_INT(i*100, readState.position);
+        TEST_ASSERT_EQUAL_INT(-i, readState.velocity);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, latest.retries);
+}
+
+void test_WriterAlternatesSlots(void) {
+    uint32_t storage[2] = {0};
+    OS_LatestValueTypeDef latest;
+    OS_LatestValueInit(&latest, storage, sizeof(uint32_t));
+
+    uint32_t value = 11;
+    OS_LatestValueWrite(&latest, &value);
+    value = 22;
+    OS_LatestValueWrite(&latest, &value);
+
+    TEST_ASSERT_EQUAL_INT(22, storage[0]);
+    TEST_ASSERT_EQUAL_INT(11, storage[1]);
+    TEST_ASSERT_EQUAL_INT(4, latest.sequence);
+}
+
+void test_ReadDuringWriteReturnsLastCompletedValue(void) {
+    uint32_t storage[2] = {0};
+    OS_LatestValueTypeDef latest;
+    OS_LatestValueInit(&latest, storage, sizeof(uint32_t));
+
+    uint32_t value = 11;
+    OS_LatestValueWrite(&latest, &value);
+
+    // Simulate the reader preempting the writer half way through the second write
+    latest.sequence++;
+    storage[0] = 0xDEAD;
+
+    uint32_t readValue = 0;
+    TEST_ASSERT_EQUAL_INT(1, OS_LatestValueRead(&latest, &readValue));
+    TEST_ASSERT_EQUAL_INT(11, readValue);
+    TEST_ASSERT_EQUAL_INT(0, latest.retries);
+}
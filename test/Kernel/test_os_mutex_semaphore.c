@@ -19,8 +19,10 @@ void setUp(void) {
     BSP_HardwareInit_Ignore();
     OS_CriticalEnter_IgnoreAndReturn(1);
     OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
 
-    StackElementTypeDef idleStack[20];
+    static StackElementTypeDef idleStack[20];
     OS_Init(&idleFn, idleStack, 20);
 }
 
@@ -169,4 +171,24 @@ void test_MutexSemaphoreUnblocksLongestWaiting(void) {
 
     TEST_ASSERT_EQUAL_STRING("test thread2", readyTailPtr->identifier);
     TEST_ASSERT_EQUAL_STRING("test thread3", blockHeadPtr->identifier);
-}
\ No newline at end of file
+}
+
+void test_MutexTryWaitDoesNotBlock(void) {
+    OS_SemaphoreObjectTypeDef testSemaphore;
+    OS_InitSemaphore(&testSemaphore, SEMAPHORE_MUTEX);
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20,3, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_CreateThread(&testFn, testStack2, 20,3, "test thread2");
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+    TEST_ASSERT_EQUAL_INT(1, OS_TryWait(&testSemaphore));
+    TEST_ASSERT_EQUAL_STRING("test thread1", testSemaphore.owner->identifier);
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread2");
+    TEST_ASSERT_EQUAL_INT(0, OS_TryWait(&testSemaphore));
+    TEST_ASSERT_EQUAL_STRING("test thread1", testSemaphore.owner->identifier);
+    TEST_ASSERT_EQUAL_INT(0, testSemaphore.value);
+    TEST_ASSERT_NOT_NULL(OS_GetReadyThreadByIdentifier("test thread2"));
+}
@@ -19,8 +19,10 @@ void setUp(void) {
     BSP_HardwareInit_Ignore();
     OS_CriticalEnter_IgnoreAndReturn(1);
     OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
 
-    StackElementTypeDef idleStack[20];
+    static StackElementTypeDef idleStack[20];
     OS_Init(&idleFn, idleStack, 20);
 }
 
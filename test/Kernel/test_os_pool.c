@@ -0,0 +1,177 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_semaphore.h"
+#include "os_scheduling.h"
+#include "os_pool.h"
+#include "mock_bsp.h"
+
+#define EXPECT_SCHEDULER() BSP_TriggerPendSV_Expect()
+#define EXPECT_BLOCKED() BSP_TriggerPendSV_Expect()
+
+#define BLOCK_SIZE OS_POOL_BLOCK_SIZE(10)
+
+static void idleFn(void *ptr) {}
+static void testFn(void *ptr) {}
+
+static OS_POOL_DECLARE(testStorage, 10, 4);
+
+// BASEPRI model for interleaving tests. When a thread leaves its outermost critical section, whatever was waiting
+// for interrupts to be unmasked gets to run there.
+static uint32_t basePri = 0;
+static void (*onUnmask)(void) = NULL;
+
+static uint32_t criticalEnterStub(int numCalls) {
+    uint32_t previous = basePri;
+    basePri = MAX_SYSCALL_INTERRUPT_PRIORITY;
+    return previous;
+}
+
+static void criticalExitStub(uint32_t priority, int numCalls) {
+    basePri = priority;
+    if (basePri == 0 && onUnmask != NULL) {
+        void (*preemption)(void) = onUnmask;
+        onUnmask = NULL;
+        preemption();
+    }
+}
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+void test_PoolAllocatesDistinctBlocks(void) {
+    OS_PoolTypeDef pool;
+    OS_PoolInit(&pool, testStorage, BLOCK_SIZE, 4);
+
+    uint8_t *blocks[4];
+    for (int i = 0; i < 4; i++) {
+        blocks[i] = OS_PoolAlloc(&pool);
+        TEST_ASSERT_EQUAL_PTR((uint8_t *)testStorage + (i*BLOCK_SIZE), blocks[i]);
+    }
+
+    TEST_ASSERT_EQUAL_INT(4, pool.inUse);
+    TEST_ASSERT_EQUAL_INT(4, pool.highWater);
+    TEST_ASSERT_EQUAL_INT(0, pool.failed);
+}
+
+void test_PoolAllocFailsWhenEmpty(void) {
+    OS_PoolTypeDef pool;
+    OS_PoolInit(&pool, testStorage, BLOCK_SIZE, 4);
+
+    for (int i = 0; i < 4; i++) {
+        OS_PoolAlloc(&pool);
+    }
+
+    TEST_ASSERT_EQUAL_PTR(NULL, OS_PoolAlloc(&pool));
+    TEST_ASSERT_EQUAL_PTR(NULL, OS_PoolAlloc(&pool));
+    TEST_ASSERT_EQUAL_INT(2, pool.failed);
+}
+
+void test_PoolFreedBlockIsReused(void) {
+    OS_PoolTypeDef pool;
+    OS_PoolInit(&pool, testStorage, BLOCK_SIZE, 4);
+
+    void *block1 = OS_PoolAlloc(&pool);
+    void *block2 = OS_PoolAlloc(&pool);
+    OS_PoolFree(&pool, block1);
+    TEST_ASSERT_EQUAL_INT(1, pool.inUse);
+    TEST_ASSERT_EQUAL_INT(2, pool.highWater);
+
+    TEST_ASSERT_EQUAL_PTR(block1, OS_PoolAlloc(&pool));
+    OS_PoolFree(&pool, block2);
+    TEST_ASSERT_EQUAL_PTR(block2, OS_PoolAlloc(&pool));
+    TEST_ASSERT_EQUAL_INT(2, pool.highWater);
+}
+
+void test_PoolBlockingAllocWaitsForFree(void) {
+    OS_PoolTypeDef pool;
+    OS_PoolInit(&pool, testStorage, BLOCK_SIZE, 1);
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_CreateThread(&testFn, testStack2, 20, 3, "test thread2");
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread2");
+    void *block = OS_PoolAllocBlocking(&pool);
+    TEST_ASSERT_NOT_NULL(block);
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+    EXPECT_BLOCKED();
+    OS_PoolAllocBlocking(&pool);
+    TEST_ASSERT_NOT_NULL(OS_GetBlockedThreadByIdentifier("test thread1"));
+    TEST_ASSERT_EQUAL_INT(0, pool.failed);
+
+    // Freeing hands the block to the higher priority waiter instead of the free list
+    runPtr = OS_GetReadyThreadByIdentifier("test thread2");
+    EXPECT_SCHEDULER();
+    OS_PoolFree(&pool, block);
+    TEST_ASSERT_NOT_NULL(OS_GetReadyThreadByIdentifier("test thread1"));
+    TEST_ASSERT_EQUAL_PTR(block, pool.handoffList);
+    TEST_ASSERT_EQUAL_PTR(NULL, OS_PoolAlloc(&pool));
+    TEST_ASSERT_EQUAL_INT(1, pool.inUse);
+}
+
+static OS_PoolTypeDef interleavedPool;
+static void *interleavedBlocks[2];
+static void *secondWaiterBlock;
+
+static void freeBothFromISR(void) {
+    OS_PoolFree(&interleavedPool, interleavedBlocks[0]);
+    OS_PoolFree(&interleavedPool, interleavedBlocks[1]);
+}
+
+static void secondWaiterPreempts(void) {
+    OS_TCBTypeDef *firstWaiter = runPtr;
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+    // Both blocks are freed as soon as the second waiter unmasks interrupts
+    onUnmask = &freeBothFromISR;
+    secondWaiterBlock = OS_PoolAllocBlocking(&interleavedPool);
+    runPtr = firstWaiter;
+}
+
+void test_PoolHandsBlocksToInterleavedWaiters(void) {
+    BSP_TriggerPendSV_Ignore();
+    OS_CriticalEnter_StubWithCallback(&criticalEnterStub);
+    OS_CriticalExit_StubWithCallback(&criticalExitStub);
+
+    OS_PoolInit(&interleavedPool, testStorage, BLOCK_SIZE, 2);
+    interleavedBlocks[0] = OS_PoolAlloc(&interleavedPool);
+    interleavedBlocks[1] = OS_PoolAlloc(&interleavedPool);
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_CreateThread(&testFn, testStack2, 20, 2, "test thread2");
+
+    // The first waiter is preempted by the second one as soon as it unmasks interrupts, and both are still waiting
+    // when the two blocks are freed
+    runPtr = OS_GetReadyThreadByIdentifier("test thread2");
+    onUnmask = &secondWaiterPreempts;
+    void *firstWaiterBlock = OS_PoolAllocBlocking(&interleavedPool);
+
+    // Each free woke a waiter of its own, nobody is left blocked and no block is stranded
+    TEST_ASSERT_NULL(blockHeadPtr);
+    TEST_ASSERT_EQUAL_INT(0, interleavedPool.semaphore.value);
+    TEST_ASSERT_NULL(interleavedPool.handoffList);
+    TEST_ASSERT_NOT_NULL(firstWaiterBlock);
+    TEST_ASSERT_NOT_NULL(secondWaiterBlock);
+    TEST_ASSERT_NOT_EQUAL(firstWaiterBlock, secondWaiterBlock);
+    TEST_ASSERT_EQUAL_INT(2, interleavedPool.inUse);
+}
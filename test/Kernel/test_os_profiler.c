@@ -0,0 +1,73 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_profiler.h"
+#include "mock_bsp.h"
+
+static void idleFn(void *ptr) {}
+static void testFn(void *ptr) {}
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+    OS_ProfilerReset();
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+static uint32_t countFor(uint32_t pc, uint8_t threadId) {
+    for (uint32_t i = 0; i < PROFILER_BUCKETS; i++) {
+        OS_ProfilerEntryTypeDef *entry = &osProfilerBuffer.entries[i];
+        if (entry->count != 0 && entry->pc == pc && entry->threadId == threadId) {
+            return entry->count;
+        }
+    }
+
+    return 0;
+}
+
+void test_ProfilerCountsSamplesPerPCAndThread(void) {
+    OS_ProfilerSample(0x08000101, 0);
+    OS_ProfilerSample(0x08000101, 0);
+    OS_ProfilerSample(0x08000101, 1);
+    OS_ProfilerSample(0x08000201, 0);
+
+    TEST_ASSERT_EQUAL_INT(2, countFor(0x08000101, 0));
+    TEST_ASSERT_EQUAL_INT(1, countFor(0x08000101, 1));
+    TEST_ASSERT_EQUAL_INT(1, countFor(0x08000201, 0));
+    TEST_ASSERT_EQUAL_INT(4, osProfilerBuffer.samples);
+}
+
+void test_ProfilerDropsNewPairsWhenFull(void) {
+    for (uint32_t i = 0; i < PROFILER_BUCKETS; i++) {
+        OS_ProfilerSample(0x08000000 + (i*2), 0);
+    }
+    OS_ProfilerSample(0x08001000, 0);
+    // Known pairs are still counted
+    OS_ProfilerSample(0x08000000, 0);
+
+    TEST_ASSERT_EQUAL_INT(1, osProfilerBuffer.dropped);
+    TEST_ASSERT_EQUAL_INT(2, countFor(0x08000000, 0));
+    TEST_ASSERT_EQUAL_INT(PROFILER_BUCKETS + 2, osProfilerBuffer.samples);
+}
+
+void test_ProfilerSysTickSamplesRunningThread(void) {
+    StackElementTypeDef testStack[20];
+    runPtr = OS_CreateThread(&testFn, testStack, 20, 3, "test thread");
+
+    OS_ProfilerSysTick(0x08000301);
+    TEST_ASSERT_EQUAL_INT(1, countFor(0x08000301, runPtr->id));
+    TEST_ASSERT_EQUAL_INT(1, OS_GetSysTickCount());
+}
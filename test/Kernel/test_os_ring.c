@@ -0,0 +1,86 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_ring.h"
+#include "mock_bsp.h"
+
+OS_RING_DEFINE(TestRing, uint16_t, 8)
+OS_RING_DEFINE(TestWordRing, uint32_t, 4)
+
+void setUp(void) {
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+}
+
+void tearDown(void) {
+}
+
+void test_RingPutAndGet(void) {
+    TestRingTypeDef ring;
+    TestRingInit(&ring);
+
+    TestRingPut(&ring, 100);
+    TestRingPut(&ring, 200);
+    TEST_ASSERT_EQUAL_INT(2, TestRingCount(&ring));
+
+    uint16_t value = 0;
+    TEST_ASSERT_EQUAL_INT(1, TestRingGet(&ring, &value));
+    TEST_ASSERT_EQUAL_INT(100, value);
+    TEST_ASSERT_EQUAL_INT(1, TestRingGet(&ring, &value));
+    TEST_ASSERT_EQUAL_INT(200, value);
+    TEST_ASSERT_EQUAL_INT(0, TestRingGet(&ring, &value));
+}
+
+void test_RingPutOverwritesOldest(void) {
+    TestWordRingTypeDef ring;
+    TestWordRingInit(&ring);
+
+    for (uint32_t i = 0; i < 6; i++) {
+        TestWordRingPut(&ring, i);
+    }
+
+    TEST_ASSERT_EQUAL_INT(4, TestWordRingCount(&ring));
+    TEST_ASSERT_EQUAL_INT(2, ring.missed);
+
+    uint32_t value = 0;
+    for (uint32_t i = 2; i < 6; i++) {
+        TestWordRingGet(&ring, &value);
+        TEST_ASSERT_EQUAL_INT(i, value);
+    }
+}
+
+void test_RingBulkWriteAndReadRollOver(void) {
+    TestRingTypeDef ring;
+    TestRingInit(&ring);
+
+    uint16_t writeData[6] = {1, 2, 3, 4, 5, 6};
+    uint16_t readData[8] = {0};
+    TestRingWrite(&ring, writeData, 6);
+    TEST_ASSERT_EQUAL_INT(6, TestRingRead(&ring, readData, 6));
+
+    // Second write wraps around the end of the storage
+    TestRingWrite(&ring, writeData, 6);
+    TEST_ASSERT_EQUAL_INT(6, TestRingRead(&ring, readData, 8));
+    for (int i = 0; i < 6; i++) {
+        TEST_ASSERT_EQUAL_INT(writeData[i], readData[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(0, ring.missed);
+}
+
+void test_RingBulkWriteOverflow(void) {
+    TestWordRingTypeDef ring;
+    TestWordRingInit(&ring);
+
+    uint32_t writeData1[3] = {1, 2, 3};
+    uint32_t writeData2[6] = {4, 5, 6, 7, 8, 9};
+    TestWordRingWrite(&ring, writeData1, 3);
+    TestWordRingWrite(&ring, writeData2, 6);
+
+    uint32_t readData[4] = {0};
+    TEST_ASSERT_EQUAL_INT(4, TestWordRingRead(&ring, readData, 4));
+    TEST_ASSERT_EQUAL_INT(5, ring.missed);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(writeData2[i+2], readData[i]);
+    }
+}
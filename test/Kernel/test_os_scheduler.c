@@ -23,8 +23,10 @@ void setUp(void) {
     BSP_HardwareInit_Ignore();
     OS_CriticalEnter_IgnoreAndReturn(1);
     OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
 
-    StackElementTypeDef idleStack[20];
+    static StackElementTypeDef idleStack[20];
     OS_Init(&idleFn, idleStack, 20);
 }
 
@@ -174,6 +176,42 @@ void test_SleepEndRunsScheduler(void) {
     TEST_ASSERT_EQUAL_STRING("test thread1", runPtr->identifier);
 }
 
+void test_SleepListIsOrderedByWakeTick(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_CreateThread(&testFn, testStack2, 20, 3, "test thread2");
+    StackElementTypeDef testStack3[20];
+    OS_CreateThread(&testFn, testStack3, 20, 2, "test thread3");
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+    OS_Sleep(5*SYS_TICK_PERIOD_MILLIS);
+    runPtr = OS_GetReadyThreadByIdentifier("test thread2");
+    OS_Sleep(2*SYS_TICK_PERIOD_MILLIS);
+    runPtr = OS_GetReadyThreadByIdentifier("test thread3");
+    OS_Sleep(OS_WAIT_FOREVER);
+
+    // Lower priority thread wakes first, so it is at the head regardless of priority
+    TEST_ASSERT_EQUAL_STRING("test thread2", sleepHeadPtr->identifier);
+    TEST_ASSERT_EQUAL_STRING("test thread1", sleepHeadPtr->next->identifier);
+    TEST_ASSERT_EQUAL_STRING("test thread3", sleepTailPtr->identifier);
+
+    runPtr = idlePtr;
+    for (int i = 0; i < 2; i++) {
+        SysTick_Handler();
+    }
+    TEST_ASSERT_NOT_NULL(OS_GetReadyThreadByIdentifier("test thread2"));
+    TEST_ASSERT_NOT_NULL(OS_GetSleepingThreadByIdentifier("test thread1"));
+
+    for (int i = 0; i < 3; i++) {
+        SysTick_Handler();
+    }
+    TEST_ASSERT_NOT_NULL(OS_GetReadyThreadByIdentifier("test thread1"));
+    TEST_ASSERT_EQUAL_PTR(OS_GetSleepingThreadByIdentifier("test thread3"), sleepHeadPtr);
+}
+
 void test_periodicThreadGetsScheduled(void) {
     BSP_TriggerPendSV_AddCallback(&pendSVStub);
 
@@ -228,4 +266,401 @@ void test_periodicThreadRunsTooLong(void) {
     EXPECT_SCHEDULER();
     SysTick_Handler();
     TEST_ASSERT_EQUAL_PTR(OS_GetReadyThreadByIdentifier("periodic thread1"), runPtr);
-}
\ No newline at end of file
+}
+
+void test_SleepUntilDoesNotDriftByWorkTime(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *thread1 = OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    uint64_t start = OS_GetSysTickCount();
+    uint64_t lastWake = start;
+
+    for (uint32_t period = 1; period <= 3; period++) {
+        // Thread works for 2 ticks before sleeping, and still wakes up on the 5 tick grid
+        runPtr = thread1;
+        for (int i = 0; i < 2; i++) {
+            SysTick_Handler();
+        }
+        TEST_ASSERT_EQUAL_INT(1, OS_SleepUntil(&lastWake, 5*SYS_TICK_PERIOD_MILLIS));
+        OS_Schedule();
+        TEST_ASSERT_EQUAL_PTR(idlePtr, runPtr);
+        for (int i = 0; i < 3; i++) {
+            TEST_ASSERT_NOT_NULL(OS_GetSleepingThreadByIdentifier("test thread1"));
+            SysTick_Handler();
+        }
+        TEST_ASSERT_EQUAL_PTR(thread1, readyHeadPtr);
+        TEST_ASSERT_EQUAL_INT(start + period*5, OS_GetSysTickCount());
+    }
+
+    // Work longer than the period does not sleep at all
+    runPtr = thread1;
+    for (int i = 0; i < 6; i++) {
+        SysTick_Handler();
+    }
+    TEST_ASSERT_EQUAL_INT(0, OS_SleepUntil(&lastWake, 5*SYS_TICK_PERIOD_MILLIS));
+    TEST_ASSERT_EQUAL_INT(start + 20, lastWake);
+}
+
+void test_PhasedPeriodicThreadReleasesOnShiftedGrid(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *periodic = OS_CreatePhasedPeriodicThread(&testFn, testStack1, 20, 1, 10*SYS_TICK_PERIOD_MILLIS,
+                                                            3*SYS_TICK_PERIOD_MILLIS, "periodic thread1");
+    runPtr = idlePtr;
+
+    for (uint32_t release = 0; release < 3; release++) {
+        uint32_t ticksToRelease = release == 0 ? 13 : 10;
+        for (uint32_t i = 0; i < ticksToRelease - 1; i++) {
+            SysTick_Handler();
+        }
+        TEST_ASSERT_NULL(readyHeadPtr);
+        SysTick_Handler();
+        TEST_ASSERT_EQUAL_PTR(periodic, readyHeadPtr);
+
+        // Thread is done with this release
+        runPtr = periodic;
+        OS_Suspend(OS_SUSPEND_RELINQUISH);
+        OS_Schedule();
+        TEST_ASSERT_EQUAL_PTR(idlePtr, runPtr);
+    }
+}
+
+void test_AssignedPhasesSpreadHarmonicReleases(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *periodic1 = OS_CreatePeriodicThread(&testFn, testStack1, 20, 1, 10*SYS_TICK_PERIOD_MILLIS, "periodic thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *periodic2 = OS_CreatePeriodicThread(&testFn, testStack2, 20, 2, 20*SYS_TICK_PERIOD_MILLIS, "periodic thread2");
+    StackElementTypeDef testStack3[20];
+    OS_TCBTypeDef *periodic3 = OS_CreatePeriodicThread(&testFn, testStack3, 20, 3, 40*SYS_TICK_PERIOD_MILLIS, "periodic thread3");
+    runPtr = idlePtr;
+
+    uint64_t start = OS_GetSysTickCount();
+    TEST_ASSERT_EQUAL_INT(0, OS_AssignPeriodicPhases());
+    // Highest priority keeps phase 0, the others take the first free slots on the grid of the shorter periods
+    TEST_ASSERT_EQUAL_INT(start + 10, periodic1->nextRelease);
+    TEST_ASSERT_EQUAL_INT(start + 21, periodic2->nextRelease);
+    TEST_ASSERT_EQUAL_INT(start + 42, periodic3->nextRelease);
+
+    // Over two hyperperiods no two threads are released on the same tick
+    for (uint32_t i = 0; i < 80; i++) {
+        SysTick_Handler();
+        if (readyHeadPtr != NULL) {
+            TEST_ASSERT_NULL(readyHeadPtr->next);
+            runPtr = readyHeadPtr;
+            OS_Suspend(OS_SUSPEND_RELINQUISH);
+            OS_Schedule();
+            TEST_ASSERT_EQUAL_PTR(idlePtr, runPtr);
+        }
+    }
+}
+
+void test_AssignedPhasesReportUnavoidableCollisions(void) {
+    StackElementTypeDef testStack1[20];
+    OS_CreatePeriodicThread(&testFn, testStack1, 20, 1, 2*SYS_TICK_PERIOD_MILLIS, "periodic thread1");
+    StackElementTypeDef testStack2[20];
+    OS_CreatePeriodicThread(&testFn, testStack2, 20, 2, 2*SYS_TICK_PERIOD_MILLIS, "periodic thread2");
+    StackElementTypeDef testStack3[20];
+    OS_CreatePeriodicThread(&testFn, testStack3, 20, 3, 3*SYS_TICK_PERIOD_MILLIS, "periodic thread3");
+
+    // Periods 2 and 3 are coprime, the third thread meets both of the others whatever its phase
+    TEST_ASSERT_EQUAL_INT(2, OS_AssignPeriodicPhases());
+}
+
+void test_RunTimeIsChargedToThreadsAtContextSwitch(void) {
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *thread1 = OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+
+    // Idle runs until t=100, thread1 until t=250 when it blocks itself
+    BSP_GetTimestamp_IgnoreAndReturn(100);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(thread1, runPtr);
+    TEST_ASSERT_EQUAL_INT(100, thread1->lastActivated);
+
+    BSP_GetTimestamp_IgnoreAndReturn(250);
+    OS_ReadyListRemove(thread1);
+    OS_BlockedListInsert(thread1);
+    EXPECT_SCHEDULER();
+    OS_Suspend(OS_SUSPEND_BLOCK);
+    OS_Schedule();
+
+    TEST_ASSERT_EQUAL_PTR(idlePtr, runPtr);
+    TEST_ASSERT_EQUAL_INT(150, thread1->runTime);
+    TEST_ASSERT_EQUAL_INT(1, thread1->voluntarySwitches);
+    TEST_ASSERT_EQUAL_INT(0, thread1->preemptiveSwitches);
+    TEST_ASSERT_EQUAL_INT(100, idlePtr->runTime);
+    TEST_ASSERT_EQUAL_INT(1, idlePtr->preemptiveSwitches);
+
+    OS_ThreadStatsTypeDef stats[NUM_USER_THREADS+1];
+    BSP_GetTimestamp_IgnoreAndReturn(300);
+    TEST_ASSERT_EQUAL_INT(2, OS_GetThreadStats(stats, NUM_USER_THREADS+1));
+    TEST_ASSERT_EQUAL_STRING("idle thread", stats[0].identifier);
+    TEST_ASSERT_EQUAL_INT(150, stats[0].runTime);
+    TEST_ASSERT_EQUAL_STRING("test thread1", stats[1].identifier);
+    TEST_ASSERT_EQUAL_INT(150, stats[1].runTime);
+    TEST_ASSERT_EQUAL_INT(1, OS_GetThreadStats(stats, 1));
+}
+
+void test_CPULoadIsDerivedFromIdleTime(void) {
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+
+    BSP_GetTimestamp_IgnoreAndReturn(1000);
+    OS_GetCPULoad();
+
+    // Idle runs 250 and thread1 750 of the next 1000 timestamp ticks
+    BSP_GetTimestamp_IgnoreAndReturn(1250);
+    OS_Schedule();
+    BSP_GetTimestamp_IgnoreAndReturn(2000);
+    TEST_ASSERT_EQUAL_INT(75, OS_GetCPULoad());
+
+    // Timestamp rolls over during the window, thread1 keeps running
+    BSP_GetTimestamp_IgnoreAndReturn(0xFFFFFF00);
+    OS_GetCPULoad();
+    BSP_GetTimestamp_IgnoreAndReturn(0x100);
+    TEST_ASSERT_EQUAL_INT(100, OS_GetCPULoad());
+}
+
+static OS_TCBTypeDef *throttledThread;
+
+static void budgetHook(OS_TCBTypeDef *thread) {
+    throttledThread = thread;
+}
+
+void test_RunawayThreadIsThrottledUntilNextWindow(void) {
+    BSP_TriggerPendSV_Ignore();
+    throttledThread = NULL;
+    OS_SetBudgetHook(&budgetHook);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *runaway = OS_CreateThread(&testFn, testStack1, 20, 1, "runaway");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *background = OS_CreateThread(&testFn, testStack2, 20, 5, "background");
+    OS_SetThreadBudget(runaway, 2, 10*SYS_TICK_PERIOD_MILLIS);
+    uint32_t budget = 2 * SYSCLOCK_FREQUENCY;
+
+    BSP_GetTimestamp_IgnoreAndReturn(1000);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(runaway, runPtr);
+
+    // Never gives up the CPU, but is throttled by the SysTick once it has used its budget
+    BSP_GetTimestamp_IgnoreAndReturn(1000 + budget - 1);
+    SysTick_Handler();
+    TEST_ASSERT_NULL(throttledThread);
+    BSP_GetTimestamp_IgnoreAndReturn(1000 + budget);
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_PTR(runaway, throttledThread);
+    TEST_ASSERT_EQUAL_INT(1, runaway->budgetOverruns);
+
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(background, runPtr);
+
+    for (uint32_t i = 0; i < 7; i++) {
+        SysTick_Handler();
+        OS_Schedule();
+        TEST_ASSERT_EQUAL_PTR(background, runPtr);
+    }
+    // New window starts 10 ticks after the budget was set
+    SysTick_Handler();
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(runaway, runPtr);
+    TEST_ASSERT_EQUAL_INT(0, runaway->budgetUsed);
+}
+
+void test_BudgetIsOnlyChargedWhileRunning(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *thread1 = OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    OS_SetThreadBudget(thread1, 2, 10*SYS_TICK_PERIOD_MILLIS);
+    uint32_t budget = 2 * SYSCLOCK_FREQUENCY;
+
+    BSP_GetTimestamp_IgnoreAndReturn(1000);
+    OS_Schedule();
+
+    // Half the budget used before sleeping, the sleep itself is charged to the idle thread
+    BSP_GetTimestamp_IgnoreAndReturn(1000 + budget / 2);
+    OS_Sleep(2*SYS_TICK_PERIOD_MILLIS);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(idlePtr, runPtr);
+    TEST_ASSERT_EQUAL_INT(budget / 2, thread1->budgetUsed);
+
+    BSP_GetTimestamp_IgnoreAndReturn(1000 + 2 * budget);
+    SysTick_Handler();
+    SysTick_Handler();
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(thread1, runPtr);
+    TEST_ASSERT_EQUAL_INT(0, thread1->budgetThrottled);
+    TEST_ASSERT_EQUAL_INT(budget / 2, thread1->budgetUsed);
+}
+
+void test_BudgetWindowsOfDifferentLengthsEndOnTheirOwnTicks(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *shortWindow = OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *longWindow = OS_CreateThread(&testFn, testStack2, 20, 2, "test thread2");
+    StackElementTypeDef testStack3[20];
+    OS_TCBTypeDef *background = OS_CreateThread(&testFn, testStack3, 20, 5, "test thread3");
+    OS_SetThreadBudget(longWindow, 2, 10*SYS_TICK_PERIOD_MILLIS);
+    OS_SetThreadBudget(shortWindow, 2, 5*SYS_TICK_PERIOD_MILLIS);
+    uint64_t start = OS_GetSysTickCount();
+    uint32_t budget = 2 * SYSCLOCK_FREQUENCY;
+
+    BSP_GetTimestamp_IgnoreAndReturn(1000);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(shortWindow, runPtr);
+    BSP_GetTimestamp_IgnoreAndReturn(1000 + budget);
+    SysTick_Handler();
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(longWindow, runPtr);
+    BSP_GetTimestamp_IgnoreAndReturn(1000 + 2 * budget);
+    SysTick_Handler();
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(background, runPtr);
+
+    for (uint32_t i = 0; i < 2; i++) {
+        SysTick_Handler();
+        OS_Schedule();
+        TEST_ASSERT_EQUAL_PTR(background, runPtr);
+    }
+    SysTick_Handler();
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(shortWindow, runPtr);
+    TEST_ASSERT_EQUAL_INT(1, longWindow->budgetThrottled);
+
+    // A deleted thread no longer has a window to end
+    OS_DeleteThread(shortWindow);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(background, runPtr);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        SysTick_Handler();
+        OS_Schedule();
+        TEST_ASSERT_EQUAL_PTR(background, runPtr);
+    }
+    SysTick_Handler();
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(longWindow, runPtr);
+    TEST_ASSERT_EQUAL_INT(start + 20, longWindow->budgetWindowEnd);
+}
+
+void test_ThreadOverBudgetRunsUntilItReleasesItsMutex(void) {
+    BSP_TriggerPendSV_Ignore();
+    OS_SemaphoreObjectTypeDef mutex;
+    OS_InitSemaphore(&mutex, SEMAPHORE_MUTEX);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *owner = OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *background = OS_CreateThread(&testFn, testStack2, 20, 5, "test thread2");
+    OS_SetThreadBudget(owner, 2, 10*SYS_TICK_PERIOD_MILLIS);
+    uint32_t budget = 2 * SYSCLOCK_FREQUENCY;
+
+    BSP_GetTimestamp_IgnoreAndReturn(1000);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(owner, runPtr);
+    OS_Wait(&mutex);
+
+    StackElementTypeDef testStack3[20];
+    OS_TCBTypeDef *urgent = OS_CreateThread(&testFn, testStack3, 20, 1, "test thread3");
+    runPtr = urgent;
+    OS_Wait(&mutex);
+    TEST_ASSERT_EQUAL_INT(1, owner->priority);
+    runPtr = owner;
+
+    // Out of budget inside the mutex, throttling would stall the urgent thread waiting for it
+    BSP_GetTimestamp_IgnoreAndReturn(1000 + budget);
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_INT(1, owner->budgetThrottled);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(owner, runPtr);
+
+    OS_Signal(&mutex);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(urgent, runPtr);
+
+    // Without the mutex the owner is throttled again
+    OS_Sleep(OS_WAIT_FOREVER);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(background, runPtr);
+}
+
+void test_ThreadOverBudgetHoldingUncontendedMutexIsThrottled(void) {
+    BSP_TriggerPendSV_Ignore();
+    OS_SemaphoreObjectTypeDef mutex;
+    OS_InitSemaphore(&mutex, SEMAPHORE_MUTEX);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *owner = OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *background = OS_CreateThread(&testFn, testStack2, 20, 5, "test thread2");
+    OS_SetThreadBudget(owner, 2, 10*SYS_TICK_PERIOD_MILLIS);
+    uint32_t budget = 2 * SYSCLOCK_FREQUENCY;
+
+    BSP_GetTimestamp_IgnoreAndReturn(1000);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(owner, runPtr);
+    OS_Wait(&mutex);
+
+    // Nobody waits for the mutex, so holding it does not let the owner overrun its budget
+    BSP_GetTimestamp_IgnoreAndReturn(1000 + budget);
+    SysTick_Handler();
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(background, runPtr);
+    TEST_ASSERT_EQUAL_PTR(owner, mutex.owner);
+}
+
+void test_WakeupLatencyIsMeasuredFromReadyToDispatch(void) {
+    StackElementTypeDef testStack1[20];
+    BSP_GetTimestamp_IgnoreAndReturn(100);
+    OS_TCBTypeDef *thread1 = OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+
+    BSP_GetTimestamp_IgnoreAndReturn(103);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(thread1, runPtr);
+
+    // Sleep expires at 1000, thread dispatched at 1040
+    EXPECT_SCHEDULER();
+    OS_Sleep(10);
+    OS_Schedule();
+    BSP_GetTimestamp_IgnoreAndReturn(1000);
+    OS_SleepListRemove(thread1);
+    OS_ReadyListInsert(thread1);
+    BSP_GetTimestamp_IgnoreAndReturn(1040);
+    OS_Schedule();
+
+    // Running again without becoming ready in between is not a wakeup
+    OS_Schedule();
+
+    OS_LatencyStatsTypeDef stats;
+    OS_GetWakeupLatency(thread1, &stats);
+    TEST_ASSERT_EQUAL_INT(2, stats.count);
+    TEST_ASSERT_EQUAL_INT(3, stats.min);
+    TEST_ASSERT_EQUAL_INT(40, stats.max);
+    TEST_ASSERT_EQUAL_INT(1, stats.histogram[2]);
+    TEST_ASSERT_EQUAL_INT(1, stats.histogram[6]);
+
+    OS_ResetWakeupLatency(thread1);
+    OS_GetWakeupLatency(thread1, &stats);
+    TEST_ASSERT_EQUAL_INT(0, stats.count);
+}
+
+void test_PriorityResortKeepsReadyTimestamp(void) {
+    StackElementTypeDef testStack1[20];
+    BSP_GetTimestamp_IgnoreAndReturn(100);
+    OS_TCBTypeDef *thread1 = OS_CreateThread(&testFn, testStack1, 20, 5, "test thread1");
+
+    BSP_GetTimestamp_IgnoreAndReturn(150);
+    OS_ReadyListRemove(thread1);
+    thread1->priority = 2;
+    OS_ReadyListInsert(thread1);
+
+    BSP_GetTimestamp_IgnoreAndReturn(200);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_INT(100, thread1->wakeupLatency.max);
+}
@@ -0,0 +1,239 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_semaphore.h"
+#include "os_scheduling.h"
+#include "os_buffers.h"
+#include "os_select.h"
+#include "mock_bsp.h"
+
+#define EXPECT_SCHEDULER() BSP_TriggerPendSV_Expect()
+#define EXPECT_BLOCKED() BSP_TriggerPendSV_Expect()
+
+static void idleFn(void *ptr) {}
+static void testFn(void *ptr) {}
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+void test_WaitAnyReturnsReadySemaphoreWithoutBlocking(void) {
+    OS_SemaphoreObjectTypeDef testSemaphore0;
+    OS_InitSemaphore(&testSemaphore0, SEMAPHORE_FLAG);
+    OS_SemaphoreObjectTypeDef testSemaphore1;
+    OS_InitSemaphore(&testSemaphore1, SEMAPHORE_FLAG);
+    OS_SelectObjectTypeDef objects[2] = {{SELECT_SEMAPHORE, &testSemaphore0}, {SELECT_SEMAPHORE, &testSemaphore1}};
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+
+    OS_Signal(&testSemaphore1);
+    TEST_ASSERT_EQUAL_INT(1, OS_WaitAny(objects, 2, OS_WAIT_FOREVER));
+    TEST_ASSERT_EQUAL_INT(0, testSemaphore1.value);
+    TEST_ASSERT_EQUAL_PTR(runPtr, OS_GetReadyThreadByIdentifier("test thread1"));
+}
+
+void test_WaitAnyWithZeroTimeoutDoesNotBlock(void) {
+    OS_SemaphoreObjectTypeDef testSemaphore;
+    OS_InitSemaphore(&testSemaphore, SEMAPHORE_FLAG);
+    OS_SelectObjectTypeDef objects[1] = {{SELECT_SEMAPHORE, &testSemaphore}};
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+
+    TEST_ASSERT_EQUAL_INT(OS_WAIT_TIMEOUT, OS_WaitAny(objects, 1, 0));
+    TEST_ASSERT_EQUAL_PTR(runPtr, OS_GetReadyThreadByIdentifier("test thread1"));
+}
+
+void test_SignalWakesWaitingThreadOnce(void) {
+    OS_SemaphoreObjectTypeDef testSemaphore0;
+    OS_InitSemaphore(&testSemaphore0, SEMAPHORE_FLAG);
+    OS_SemaphoreObjectTypeDef testSemaphore1;
+    OS_InitSemaphore(&testSemaphore1, SEMAPHORE_FLAG);
+    OS_SelectObjectTypeDef objects[2] = {{SELECT_SEMAPHORE, &testSemaphore0}, {SELECT_SEMAPHORE, &testSemaphore1}};
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_CreateThread(&testFn, testStack2, 20, 3, "test thread2");
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+    EXPECT_BLOCKED();
+    OS_WaitAny(objects, 2, OS_WAIT_FOREVER);
+    TEST_ASSERT_NOT_NULL(OS_GetSleepingThreadByIdentifier("test thread1"));
+
+    // Higher priority thread woken, so signaling thread gets suspended
+    runPtr = OS_GetReadyThreadByIdentifier("test thread2");
+    EXPECT_SCHEDULER();
+    OS_Signal(&testSemaphore1);
+
+    OS_TCBTypeDef *woken = OS_GetReadyThreadByIdentifier("test thread1");
+    TEST_ASSERT_NOT_NULL(woken);
+    TEST_ASSERT_EQUAL_INT(1, woken->waitResult);
+    TEST_ASSERT_EQUAL_PTR(NULL, woken->waitObjects);
+    // The semaphore was handed over to the woken thread
+    TEST_ASSERT_EQUAL_INT(0, testSemaphore1.value);
+
+    // Second object becoming ready must not wake the thread again
+    OS_Signal(&testSemaphore0);
+    TEST_ASSERT_EQUAL_INT(1, testSemaphore0.value);
+    TEST_ASSERT_EQUAL_INT(1, woken->waitResult);
+}
+
+void test_SignalWakesHighestPriorityWaiterFirst(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    OS_SemaphoreObjectTypeDef testSemaphore;
+    OS_InitSemaphore(&testSemaphore, SEMAPHORE_FLAG);
+    OS_SelectObjectTypeDef objects[1] = {{SELECT_SEMAPHORE, &testSemaphore}};
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *low1 = OS_CreateThread(&testFn, testStack1, 20, 4, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *high = OS_CreateThread(&testFn, testStack2, 20, 2, "test thread2");
+    StackElementTypeDef testStack3[20];
+    OS_TCBTypeDef *low2 = OS_CreateThread(&testFn, testStack3, 20, 4, "test thread3");
+
+    // The low priority waiter times out first, so it is ahead of the others in the sleep list
+    runPtr = low1;
+    OS_WaitAny(objects, 1, 5*SYS_TICK_PERIOD_MILLIS);
+    runPtr = high;
+    OS_WaitAny(objects, 1, OS_WAIT_FOREVER);
+    runPtr = low2;
+    OS_WaitAny(objects, 1, OS_WAIT_FOREVER);
+    runPtr = idlePtr;
+
+    OS_Signal(&testSemaphore);
+    TEST_ASSERT_EQUAL_PTR(high, OS_GetReadyThreadByIdentifier("test thread2"));
+    TEST_ASSERT_NOT_NULL(OS_GetSleepingThreadByIdentifier("test thread1"));
+
+    // Equal priorities are woken in the order they started waiting
+    OS_Signal(&testSemaphore);
+    TEST_ASSERT_EQUAL_PTR(low1, OS_GetReadyThreadByIdentifier("test thread1"));
+    TEST_ASSERT_EQUAL_PTR(low2, OS_GetSleepingThreadByIdentifier("test thread3"));
+}
+
+void test_BufferWriteWakesWaitingThread(void) {
+    uint32_t data[10] = {0};
+    OS_BufferTypeDef testBuffer;
+    OS_BufferInit(&testBuffer, data, 10, sizeof(uint32_t));
+    OS_SemaphoreObjectTypeDef testSemaphore;
+    OS_InitSemaphore(&testSemaphore, SEMAPHORE_FLAG);
+    OS_SelectObjectTypeDef objects[2] = {{SELECT_SEMAPHORE, &testSemaphore}, {SELECT_BUFFER, &testBuffer}};
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_CreateThread(&testFn, testStack2, 20, 3, "test thread2");
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+    EXPECT_BLOCKED();
+    OS_WaitAny(objects, 2, 100);
+
+    // Same priority, writer keeps running
+    runPtr = OS_GetReadyThreadByIdentifier("test thread2");
+    uint32_t writeData[2] = {1, 2};
+    OS_BufferWrite(&testBuffer, writeData, 2);
+
+    OS_TCBTypeDef *woken = OS_GetReadyThreadByIdentifier("test thread1");
+    TEST_ASSERT_NOT_NULL(woken);
+    TEST_ASSERT_EQUAL_INT(1, woken->waitResult);
+    TEST_ASSERT_EQUAL_INT(0, woken->sleep);
+    // The data is not consumed by the wake up
+    TEST_ASSERT_EQUAL_INT(8, testBuffer.spaceRemaining);
+}
+
+void test_BufferWriteFromISRDefersReschedule(void) {
+    uint32_t data[10] = {0};
+    OS_BufferTypeDef testBuffer;
+    OS_BufferInit(&testBuffer, data, 10, sizeof(uint32_t));
+    OS_SelectObjectTypeDef objects[1] = {{SELECT_BUFFER, &testBuffer}};
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+    EXPECT_BLOCKED();
+    OS_WaitAny(objects, 1, OS_WAIT_FOREVER);
+
+    // ISR interrupting the idle thread, the woken thread only gets to run once the ISR yields
+    runPtr = idlePtr;
+    uint32_t writeData[2] = {1, 2};
+    OS_BufferWriteFromISR(&testBuffer, writeData, 2);
+    OS_BufferWriteFromISR(&testBuffer, writeData, 2);
+
+    OS_TCBTypeDef *woken = OS_GetReadyThreadByIdentifier("test thread1");
+    TEST_ASSERT_NOT_NULL(woken);
+    TEST_ASSERT_EQUAL_INT(0, woken->waitResult);
+    TEST_ASSERT_EQUAL_INT(6, testBuffer.spaceRemaining);
+
+    EXPECT_SCHEDULER();
+    OS_YieldFromISR();
+}
+
+void test_WaitAnyTimesOut(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    OS_SemaphoreObjectTypeDef testSemaphore;
+    OS_InitSemaphore(&testSemaphore, SEMAPHORE_FLAG);
+    OS_SelectObjectTypeDef objects[1] = {{SELECT_SEMAPHORE, &testSemaphore}};
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+    OS_WaitAny(objects, 1, 3*SYS_TICK_PERIOD_MILLIS);
+    runPtr = idlePtr;
+
+    for (int i = 0; i < 3; i++) {
+        SysTick_Handler();
+    }
+
+    OS_TCBTypeDef *woken = OS_GetReadyThreadByIdentifier("test thread1");
+    TEST_ASSERT_NOT_NULL(woken);
+    TEST_ASSERT_EQUAL_INT(OS_WAIT_TIMEOUT, woken->waitResult);
+    TEST_ASSERT_EQUAL_PTR(NULL, woken->waitObjects);
+
+    // Signal after the timeout should not be handed to the thread
+    OS_Signal(&testSemaphore);
+    TEST_ASSERT_EQUAL_INT(1, testSemaphore.value);
+}
+
+void test_WaitForeverDoesNotTimeOut(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    OS_SemaphoreObjectTypeDef testSemaphore;
+    OS_InitSemaphore(&testSemaphore, SEMAPHORE_FLAG);
+    OS_SelectObjectTypeDef objects[1] = {{SELECT_SEMAPHORE, &testSemaphore}};
+
+    StackElementTypeDef testStack1[20];
+    OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+
+    runPtr = OS_GetReadyThreadByIdentifier("test thread1");
+    OS_WaitAny(objects, 1, OS_WAIT_FOREVER);
+    runPtr = idlePtr;
+
+    for (int i = 0; i < 20; i++) {
+        SysTick_Handler();
+    }
+
+    TEST_ASSERT_NOT_NULL(OS_GetSleepingThreadByIdentifier("test thread1"));
+    TEST_ASSERT_EQUAL_INT(OS_WAIT_FOREVER, OS_GetSleepingThreadByIdentifier("test thread1")->sleep);
+}
@@ -0,0 +1,148 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_semaphore.h"
+#include "os_scheduling.h"
+#include "os_server.h"
+#include "mock_bsp.h"
+
+static void idleFn(void *ptr) {}
+static void testFn(void *ptr) {}
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+    BSP_TriggerPendSV_Ignore();
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+void test_ExhaustedServerIsPassedOverUntilReplenished(void) {
+    OS_ServerTypeDef server;
+    OS_ServerInit(&server, 2*SYS_TICK_PERIOD_MILLIS, 5*SYS_TICK_PERIOD_MILLIS);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *aperiodic = OS_CreateThread(&testFn, testStack1, 20, 1, "aperiodic");
+    OS_ServerAttach(&server, aperiodic);
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *background = OS_CreateThread(&testFn, testStack2, 20, 5, "background");
+    runPtr = aperiodic;
+
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_INT(0, server.throttled);
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_INT(1, server.throttled);
+    TEST_ASSERT_EQUAL_INT(1, server.exhaustions);
+
+    // Lower priority thread gets the CPU even though the server thread is still ready
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(background, runPtr);
+    TEST_ASSERT_EQUAL_PTR(aperiodic, readyHeadPtr);
+
+    SysTick_Handler();
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_INT(1, server.throttled);
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_INT(0, server.throttled);
+    TEST_ASSERT_EQUAL_INT(2, server.remaining);
+
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(aperiodic, runPtr);
+}
+
+void test_ThreadsOfServerShareTheBudget(void) {
+    OS_ServerTypeDef server;
+    OS_ServerInit(&server, 2*SYS_TICK_PERIOD_MILLIS, 10*SYS_TICK_PERIOD_MILLIS);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *thread1 = OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *thread2 = OS_CreateThread(&testFn, testStack2, 20, 1, "test thread2");
+    OS_ServerAttach(&server, thread1);
+    OS_ServerAttach(&server, thread2);
+
+    runPtr = thread1;
+    SysTick_Handler();
+    runPtr = thread2;
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_INT(1, server.throttled);
+
+    // Nothing else is ready, so the idle thread runs
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(idlePtr, runPtr);
+}
+
+void test_ThreadWithoutServerIsNotLimited(void) {
+    OS_ServerTypeDef server;
+    OS_ServerInit(&server, 1*SYS_TICK_PERIOD_MILLIS, 10*SYS_TICK_PERIOD_MILLIS);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *thread1 = OS_CreateThread(&testFn, testStack1, 20, 1, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *thread2 = OS_CreateThread(&testFn, testStack2, 20, 1, "test thread2");
+    OS_ServerAttach(&server, thread2);
+
+    runPtr = thread1;
+    for (uint32_t i = 0; i < 5; i++) {
+        SysTick_Handler();
+    }
+    TEST_ASSERT_EQUAL_INT(0, server.throttled);
+
+    // Round robin skips the throttled thread of the same priority
+    runPtr = thread2;
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_INT(1, server.throttled);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(thread1, runPtr);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(thread1, runPtr);
+}
+
+void test_ThreadHoldingMutexIsNotThrottled(void) {
+    OS_ServerTypeDef server;
+    OS_ServerInit(&server, 1*SYS_TICK_PERIOD_MILLIS, 10*SYS_TICK_PERIOD_MILLIS);
+    OS_SemaphoreObjectTypeDef mutex;
+    OS_InitSemaphore(&mutex, SEMAPHORE_MUTEX);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *aperiodic = OS_CreateThread(&testFn, testStack1, 20, 5, "aperiodic");
+    OS_ServerAttach(&server, aperiodic);
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *background = OS_CreateThread(&testFn, testStack2, 20, 3, "background");
+    StackElementTypeDef testStack3[20];
+    OS_TCBTypeDef *urgent = OS_CreateThread(&testFn, testStack3, 20, 1, "urgent");
+
+    runPtr = aperiodic;
+    OS_Wait(&mutex);
+    runPtr = urgent;
+    OS_Wait(&mutex);
+    TEST_ASSERT_EQUAL_INT(1, aperiodic->priority);
+
+    // Budget runs out while the urgent thread waits for the mutex, the owner keeps running on the inherited priority
+    runPtr = aperiodic;
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_INT(1, server.throttled);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(aperiodic, runPtr);
+
+    OS_Signal(&mutex);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(urgent, runPtr);
+
+    // Without the mutex the owner is throttled again
+    OS_Sleep(OS_WAIT_FOREVER);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(background, runPtr);
+}
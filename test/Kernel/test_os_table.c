@@ -0,0 +1,150 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_semaphore.h"
+#include "os_scheduling.h"
+#include "os_table.h"
+#include "mock_bsp.h"
+
+static void idleFn(void *ptr) {}
+static void testFn(void *ptr) {}
+
+// Two tasks over a hyperperiod of 4 SysTicks, task 0 every 2 ticks and task 1 once
+static const OS_TableEntryTypeDef testEntries[] = {{0, 0}, {1, 1}, {2, 0}};
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+    BSP_TriggerPendSV_Ignore();
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+}
+
+void tearDown(void) {
+    OS_TableStop();
+    OS_ResetState();
+}
+
+static void finishJob(OS_TCBTypeDef *thread) {
+    runPtr = thread;
+    OS_Suspend(OS_SUSPEND_RELINQUISH);
+    OS_Schedule();
+}
+
+void test_TableThreadWaitsForItsEntry(void) {
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *thread = OS_CreateTableThread(&testFn, testStack1, 20, "table thread1");
+
+    TEST_ASSERT_NOT_NULL(thread);
+    TEST_ASSERT_EQUAL_INT(TABLE_THREAD_PRIORITY, thread->priority);
+    TEST_ASSERT_NULL(readyHeadPtr);
+}
+
+void test_TableReleasesThreadsAtTheirOffsets(void) {
+    StackElementTypeDef testStack1[20];
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *threads[2];
+    threads[0] = OS_CreateTableThread(&testFn, testStack1, 20, "table thread1");
+    threads[1] = OS_CreateTableThread(&testFn, testStack2, 20, "table thread2");
+    // Background thread of lower priority keeps running between the table jobs
+    StackElementTypeDef testStack3[20];
+    OS_TCBTypeDef *background = OS_CreateThread(&testFn, testStack3, 20, 5, "background");
+
+    OS_ScheduleTableTypeDef table;
+    OS_TableInit(&table, testEntries, 3, 4, threads);
+    OS_TableStart(&table);
+    runPtr = background;
+
+    OS_TCBTypeDef *expected[8] = {threads[0], threads[1], threads[0], NULL, threads[0], threads[1], threads[0], NULL};
+    for (uint32_t i = 0; i < 8; i++) {
+        SysTick_Handler();
+        if (expected[i] == NULL) {
+            TEST_ASSERT_EQUAL_PTR(background, readyHeadPtr);
+            continue;
+        }
+
+        // Released thread preempts the background thread right away
+        TEST_ASSERT_EQUAL_PTR(expected[i], readyHeadPtr);
+        OS_Schedule();
+        TEST_ASSERT_EQUAL_PTR(expected[i], runPtr);
+        finishJob(expected[i]);
+        TEST_ASSERT_EQUAL_PTR(background, runPtr);
+    }
+    TEST_ASSERT_EQUAL_INT(0, table.overruns);
+}
+
+void test_UnfinishedJobIsCountedAsOverrun(void) {
+    StackElementTypeDef testStack1[20];
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *threads[2];
+    threads[0] = OS_CreateTableThread(&testFn, testStack1, 20, "table thread1");
+    threads[1] = OS_CreateTableThread(&testFn, testStack2, 20, "table thread2");
+
+    OS_ScheduleTableTypeDef table;
+    OS_TableInit(&table, testEntries, 3, 4, threads);
+    OS_TableStart(&table);
+    runPtr = idlePtr;
+
+    // Task 0 never finishes its first job, its release at offset 2 is dropped instead of queued twice
+    for (uint32_t i = 0; i < 3; i++) {
+        SysTick_Handler();
+    }
+    TEST_ASSERT_EQUAL_INT(1, table.overruns);
+    TEST_ASSERT_EQUAL_PTR(threads[0], readyHeadPtr);
+    TEST_ASSERT_EQUAL_PTR(threads[1], readyHeadPtr->next);
+    TEST_ASSERT_NULL(readyHeadPtr->next->next);
+}
+
+void test_StoppedTableReleasesNothing(void) {
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *threads[1];
+    threads[0] = OS_CreateTableThread(&testFn, testStack1, 20, "table thread1");
+    static const OS_TableEntryTypeDef entries[] = {{0, 0}};
+
+    OS_ScheduleTableTypeDef table;
+    OS_TableInit(&table, entries, 1, 1, threads);
+    OS_TableStart(&table);
+    OS_TableStop();
+    runPtr = idlePtr;
+
+    SysTick_Handler();
+    TEST_ASSERT_NULL(readyHeadPtr);
+}
+
+void test_DeletedThreadIsClearedFromTable(void) {
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *threads[1];
+    threads[0] = OS_CreateTableThread(&testFn, testStack1, 20, "table thread1");
+    static const OS_TableEntryTypeDef entries[] = {{0, 0}};
+    // Taken off the ready list right away, so it must not be waiting to be dispatched
+    TEST_ASSERT_EQUAL_INT(0, threads[0]->wakeupPending);
+
+    OS_ScheduleTableTypeDef table;
+    OS_TableInit(&table, entries, 1, 1, threads);
+    OS_TableStart(&table);
+    runPtr = idlePtr;
+
+    // Fill every never used TCB, so that the next table thread gets the TCB of the deleted one
+    OS_TCBTypeDef *deleted = threads[0];
+    StackElementTypeDef testStacks[NUM_USER_THREADS][20];
+    for (int i = 0; i < NUM_USER_THREADS - 1; i++) {
+        OS_CreateThread(&testFn, testStacks[i], 20, 3, "filler");
+    }
+    OS_DeleteThread(deleted);
+    TEST_ASSERT_NULL(threads[0]);
+    OS_TCBTypeDef *recycled = OS_CreateTableThread(&testFn, testStacks[NUM_USER_THREADS-1], 20, "table thread2");
+    TEST_ASSERT_EQUAL_PTR(deleted, recycled);
+
+    // The new thread is not in this table, so the entry of the deleted thread releases nothing
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_INT(1, recycled->hasFullyRan);
+    TEST_ASSERT_EQUAL_STRING("filler", readyHeadPtr->identifier);
+}
@@ -5,8 +5,12 @@
 #include "os_threads.h"
 #include "os_semaphore.h"
 #include "os_scheduling.h"
+#include "os_pool.h"
 #include "mock_bsp.h"
 
+#define EXPECT_SCHEDULER() BSP_TriggerPendSV_Expect()
+#define EXPECT_BLOCKED() BSP_TriggerPendSV_Expect()
+
 static void idleFn(void *ptr) {}
 static void testFn(void *ptr) {}
 
@@ -16,8 +20,10 @@ void setUp(void) {
     BSP_HardwareInit_Ignore();
     OS_CriticalEnter_IgnoreAndReturn(1);
     OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
 
-    StackElementTypeDef idleStack[20];
+    static StackElementTypeDef idleStack[20];
     OS_Init(&idleFn, idleStack, 20);
 }
 
@@ -240,4 +246,317 @@ void test_PeriodicThreadCreateWorks(void) {
     TEST_ASSERT_EQUAL_PTR(NULL, readyHeadPtr);
     TEST_ASSERT_TRUE(*getPeriodicListPtr() != NULL);
     TEST_ASSERT_EQUAL_STRING("periodic thread1", (*getPeriodicListPtr())->identifier);
-}
\ No newline at end of file
+}
+
+/* ------------------------------------------ Thread deletion tests--------------------------------------------- */
+void test_DeletedThreadTCBIsReused(void) {
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *thread1 = OS_CreateThread(&testFn, testStack1, 20,3, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_CreateThread(&testFn, testStack2, 20,3, "test thread2");
+
+    OS_DeleteThread(thread1);
+    TEST_ASSERT_EQUAL_PTR(NULL, OS_GetReadyThreadByIdentifier("test thread1"));
+    TEST_ASSERT_EQUAL_STRING("test thread2", readyHeadPtr->identifier);
+    TEST_ASSERT_EQUAL_INT(INACTIVE, thread1->state);
+
+    // Fill every never used TCB, after that the deleted one is handed out
+    StackElementTypeDef testStacks[NUM_USER_THREADS][20];
+    for (int i = 0; i < NUM_USER_THREADS - 2; i++) {
+        TEST_ASSERT_NOT_NULL(OS_CreateThread(&testFn, testStacks[i], 20, 3, "filler"));
+    }
+    TEST_ASSERT_EQUAL_PTR(thread1, OS_CreateThread(&testFn, testStacks[NUM_USER_THREADS-2], 20, 3, "test thread3"));
+    TEST_ASSERT_EQUAL_INT(0, thread1->id);
+    TEST_ASSERT_EQUAL_PTR(NULL, OS_CreateThread(&testFn, testStacks[NUM_USER_THREADS-1], 20, 3, "test thread4"));
+}
+
+void test_DeletingThreadReleasesOwnedMutex(void) {
+    OS_SemaphoreObjectTypeDef mutex;
+    OS_InitSemaphore(&mutex, SEMAPHORE_MUTEX);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *owner = OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *waiter = OS_CreateThread(&testFn, testStack2, 20, 3, "test thread2");
+
+    runPtr = owner;
+    OS_Wait(&mutex);
+    runPtr = waiter;
+    EXPECT_BLOCKED();
+    OS_Wait(&mutex);
+
+    runPtr = idlePtr;
+    EXPECT_SCHEDULER();
+    OS_DeleteThread(owner);
+
+    TEST_ASSERT_EQUAL_PTR(waiter, OS_GetReadyThreadByIdentifier("test thread2"));
+    TEST_ASSERT_EQUAL_PTR(waiter, mutex.owner);
+    TEST_ASSERT_EQUAL_PTR(&mutex, waiter->ownedMutexes);
+    TEST_ASSERT_EQUAL_PTR(NULL, owner->ownedMutexes);
+}
+
+void test_DeletingBlockedAndPeriodicThreadsRemovesThem(void) {
+    OS_SemaphoreObjectTypeDef flag;
+    OS_InitSemaphore(&flag, SEMAPHORE_FLAG);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *blocked = OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *periodic1 = OS_CreatePeriodicThread(&testFn, testStack2, 20, 3, 500, "periodic thread1");
+    StackElementTypeDef testStack3[20];
+    OS_TCBTypeDef *periodic2 = OS_CreatePeriodicThread(&testFn, testStack3, 20, 3, 500, "periodic thread2");
+
+    runPtr = blocked;
+    EXPECT_BLOCKED();
+    OS_Wait(&flag);
+    runPtr = idlePtr;
+
+    OS_DeleteThread(blocked);
+    TEST_ASSERT_EQUAL_PTR(NULL, blockHeadPtr);
+    TEST_ASSERT_EQUAL_INT(0, flag.value);
+
+    OS_DeleteThread(periodic1);
+    TEST_ASSERT_EQUAL_PTR(periodic2, getPeriodicListPtr()[0]);
+    TEST_ASSERT_EQUAL_PTR(NULL, getPeriodicListPtr()[1]);
+}
+
+void test_JoinBlocksUntilThreadDeleted(void) {
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *worker = OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *joiner = OS_CreateThread(&testFn, testStack2, 20, 2, "test thread2");
+
+    runPtr = joiner;
+    EXPECT_BLOCKED();
+    OS_JoinThread(worker);
+    TEST_ASSERT_EQUAL_PTR(joiner, OS_GetBlockedThreadByIdentifier("test thread2"));
+
+    // Worker deletes itself, and the higher priority joiner gets to run
+    runPtr = worker;
+    EXPECT_SCHEDULER();
+    EXPECT_SCHEDULER();
+    OS_DeleteThread(worker);
+
+    TEST_ASSERT_EQUAL_PTR(joiner, OS_GetReadyThreadByIdentifier("test thread2"));
+    TEST_ASSERT_EQUAL_PTR(NULL, OS_GetReadyThreadByIdentifier("test thread1"));
+
+    // Joining an already deleted thread does not block
+    runPtr = joiner;
+    OS_JoinThread(worker);
+}
+
+void test_StaleHandleDoesNotReachRecycledThread(void) {
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *worker = OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    OS_ThreadHandleTypeDef handle = OS_GetThreadHandle(worker);
+    OS_DeleteThread(worker);
+
+    // Fill every never used TCB, so that the next thread gets the TCB of the worker
+    StackElementTypeDef testStacks[NUM_USER_THREADS][20];
+    for (int i = 0; i < NUM_USER_THREADS - 1; i++) {
+        OS_CreateThread(&testFn, testStacks[i], 20, 3, "filler");
+    }
+    OS_TCBTypeDef *recycled = OS_CreateThread(&testFn, testStacks[NUM_USER_THREADS-1], 20, 3, "test thread2");
+    TEST_ASSERT_EQUAL_PTR(worker, recycled);
+
+    // Neither blocks on nor deletes the thread that now owns the TCB
+    runPtr = idlePtr;
+    OS_JoinThreadHandle(handle);
+    OS_DeleteThreadHandle(handle);
+    TEST_ASSERT_EQUAL_PTR(recycled, OS_GetReadyThreadByIdentifier("test thread2"));
+    TEST_ASSERT_NULL(blockHeadPtr);
+}
+
+void test_SelfDeletedThreadIsFreedAfterContextSwitch(void) {
+    static OS_POOL_DECLARE(stackStorage, 20*sizeof(StackElementTypeDef), 1);
+    OS_PoolTypeDef stackPool;
+    OS_PoolInit(&stackPool, stackStorage, OS_POOL_BLOCK_SIZE(20*sizeof(StackElementTypeDef)), 1);
+
+    OS_TCBTypeDef *worker = OS_CreateThreadFromPool(&testFn, &stackPool, 3, "test thread1");
+    TEST_ASSERT_NOT_NULL(worker);
+    TEST_ASSERT_EQUAL_PTR(stackStorage, worker->stackBase);
+    TEST_ASSERT_EQUAL_PTR(NULL, OS_CreateThreadFromPool(&testFn, &stackPool, 3, "test thread2"));
+
+    runPtr = worker;
+    EXPECT_SCHEDULER();
+    OS_DeleteThread(worker);
+    // Still running on the pooled stack until the scheduler switches away
+    TEST_ASSERT_EQUAL_INT(1, stackPool.inUse);
+
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(idlePtr, runPtr);
+    TEST_ASSERT_EQUAL_INT(0, stackPool.inUse);
+}
+
+void test_DeletingThreadSleepingForZeroTicksKeepsReadyList(void) {
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *sleeper = OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *other = OS_CreateThread(&testFn, testStack2, 20, 3, "test thread2");
+
+    // Sleeping for zero ticks still moves the thread to the sleep list until the next tick
+    runPtr = sleeper;
+    EXPECT_SCHEDULER();
+    OS_Sleep(0);
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_INT(ASLEEP, sleeper->state);
+
+    OS_DeleteThread(sleeper);
+    TEST_ASSERT_EQUAL_PTR(NULL, sleepHeadPtr);
+    TEST_ASSERT_EQUAL_PTR(other, readyHeadPtr);
+    TEST_ASSERT_EQUAL_PTR(other, readyTailPtr);
+}
+
+void test_DeletingMutexWaiterRestoresInheritedPriorities(void) {
+    OS_SemaphoreObjectTypeDef mutex1;
+    OS_InitSemaphore(&mutex1, SEMAPHORE_MUTEX);
+    OS_SemaphoreObjectTypeDef mutex2;
+    OS_InitSemaphore(&mutex2, SEMAPHORE_MUTEX);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *owner2 = OS_CreateThread(&testFn, testStack1, 20, 6, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *owner1 = OS_CreateThread(&testFn, testStack2, 20, 5, "test thread2");
+    StackElementTypeDef testStack3[20];
+    OS_TCBTypeDef *waiter = OS_CreateThread(&testFn, testStack3, 20, 2, "test thread3");
+
+    // owner1 holds mutex1 and waits for mutex2, so the waiters priority is passed down to both owners
+    runPtr = owner2;
+    OS_Wait(&mutex2);
+    runPtr = owner1;
+    OS_Wait(&mutex1);
+    EXPECT_BLOCKED();
+    OS_Wait(&mutex2);
+    runPtr = waiter;
+    EXPECT_BLOCKED();
+    OS_Wait(&mutex1);
+    TEST_ASSERT_EQUAL_INT(2, owner1->priority);
+    TEST_ASSERT_EQUAL_INT(2, owner2->priority);
+
+    runPtr = idlePtr;
+    OS_DeleteThread(waiter);
+
+    TEST_ASSERT_EQUAL_INT(0, mutex1.value);
+    TEST_ASSERT_EQUAL_INT(0, mutex1.priorityHasBeenGranted);
+    TEST_ASSERT_EQUAL_INT(5, owner1->priority);
+    // Still inherits from owner1, which keeps waiting for mutex2
+    TEST_ASSERT_EQUAL_INT(5, owner2->priority);
+    TEST_ASSERT_EQUAL_PTR(owner2, readyHeadPtr);
+}
+
+void test_DeletingPoolWaiterDoesNotStrandFreedBlock(void) {
+    static OS_POOL_DECLARE(poolStorage, sizeof(uint32_t), 1);
+    OS_PoolTypeDef pool;
+    OS_PoolInit(&pool, poolStorage, OS_POOL_BLOCK_SIZE(sizeof(uint32_t)), 1);
+    void *block = OS_PoolAlloc(&pool);
+
+    StackElementTypeDef testStack[20];
+    OS_TCBTypeDef *waiter = OS_CreateThread(&testFn, testStack, 20, 2, "test thread1");
+    runPtr = waiter;
+    EXPECT_BLOCKED();
+    OS_PoolAllocBlocking(&pool);
+
+    runPtr = idlePtr;
+    OS_DeleteThread(waiter);
+    TEST_ASSERT_EQUAL_INT(0, pool.semaphore.value);
+
+    // Nobody is waiting any more, so the block goes back to the free list instead of the hand-off list
+    OS_PoolFree(&pool, block);
+    TEST_ASSERT_NULL(pool.handoffList);
+    TEST_ASSERT_EQUAL_INT(0, pool.inUse);
+    TEST_ASSERT_EQUAL_PTR(block, OS_PoolAlloc(&pool));
+}
+
+void test_ReapingPooledStackWakesThreadWaitingForIt(void) {
+    static OS_POOL_DECLARE(stackStorage, 20*sizeof(StackElementTypeDef), 1);
+    OS_PoolTypeDef stackPool;
+    OS_PoolInit(&stackPool, stackStorage, OS_POOL_BLOCK_SIZE(20*sizeof(StackElementTypeDef)), 1);
+
+    OS_TCBTypeDef *worker = OS_CreateThreadFromPool(&testFn, &stackPool, 3, "test thread1");
+    StackElementTypeDef testStack[20];
+    OS_TCBTypeDef *waiter = OS_CreateThread(&testFn, testStack, 20, 2, "test thread2");
+
+    runPtr = waiter;
+    EXPECT_BLOCKED();
+    OS_PoolAllocBlocking(&stackPool);
+    TEST_ASSERT_EQUAL_INT(BLOCKED, waiter->state);
+
+    runPtr = worker;
+    EXPECT_SCHEDULER();
+    OS_DeleteThread(worker);
+
+    // The scheduler hands the stack to the waiter without suspending itself, and asks for another switch instead
+    EXPECT_SCHEDULER();
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(idlePtr, runPtr);
+    TEST_ASSERT_EQUAL_PTR(waiter, readyHeadPtr);
+    TEST_ASSERT_EQUAL_PTR(stackStorage, stackPool.handoffList);
+    TEST_ASSERT_EQUAL_INT(1, stackPool.inUse);
+}
+
+void test_DeleterWakingStackWaiterSwitchesVoluntarily(void) {
+    static OS_POOL_DECLARE(stackStorage, 20*sizeof(StackElementTypeDef), 1);
+    OS_PoolTypeDef stackPool;
+    OS_PoolInit(&stackPool, stackStorage, OS_POOL_BLOCK_SIZE(20*sizeof(StackElementTypeDef)), 1);
+
+    OS_TCBTypeDef *worker = OS_CreateThreadFromPool(&testFn, &stackPool, 3, "test thread1");
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *waiter = OS_CreateThread(&testFn, testStack1, 20, 1, "test thread2");
+    StackElementTypeDef testStack2[20];
+    OS_TCBTypeDef *deleter = OS_CreateThread(&testFn, testStack2, 20, 2, "test thread3");
+
+    runPtr = waiter;
+    EXPECT_BLOCKED();
+    OS_PoolAllocBlocking(&stackPool);
+
+    runPtr = deleter;
+    EXPECT_SCHEDULER();
+    OS_DeleteThread(worker);
+    OS_Schedule();
+
+    // The deleter gave up the CPU by calling into the kernel, it was not preempted by an interrupt
+    TEST_ASSERT_EQUAL_PTR(waiter, runPtr);
+    TEST_ASSERT_EQUAL_INT(1, deleter->voluntarySwitches);
+    TEST_ASSERT_EQUAL_INT(0, deleter->preemptiveSwitches);
+}
+
+/* ------------------------------------------- Stack usage tests----------------------------------------------- */
+static OS_TCBTypeDef *overflowedThread = NULL;
+
+static void overflowHook(OS_TCBTypeDef *thread) {
+    overflowedThread = thread;
+}
+
+void test_StackHighWaterTracksDeepestUse(void) {
+    StackElementTypeDef testStack[40];
+    OS_TCBTypeDef *thread = OS_CreateThread(&testFn, testStack, 40, 3, "test thread");
+
+    // Only the initial stack frame has been written
+    TEST_ASSERT_EQUAL_INT(16, OS_GetStackHighWater(thread));
+    TEST_ASSERT_EQUAL_INT(STACK_PAINT_PATTERN, testStack[0]);
+
+    testStack[10] = 0;
+    TEST_ASSERT_EQUAL_INT(30, OS_GetStackHighWater(thread));
+    testStack[20] = STACK_PAINT_PATTERN;
+    TEST_ASSERT_EQUAL_INT(30, OS_GetStackHighWater(thread));
+}
+
+void test_OverwrittenCanaryCallsHookOnContextSwitch(void) {
+    overflowedThread = NULL;
+    OS_SetStackOverflowHook(&overflowHook);
+
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *thread1 = OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+    StackElementTypeDef testStack2[20];
+    OS_CreateThread(&testFn, testStack2, 20, 3, "test thread2");
+
+    runPtr = thread1;
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(NULL, overflowedThread);
+
+    runPtr = thread1;
+    testStack1[0] = 0x12345678;
+    OS_Schedule();
+    TEST_ASSERT_EQUAL_PTR(thread1, overflowedThread);
+    TEST_ASSERT_EQUAL_STRING("test thread2", runPtr->identifier);
+}
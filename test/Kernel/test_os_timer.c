@@ -0,0 +1,146 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_semaphore.h"
+#include "os_scheduling.h"
+#include "os_timer.h"
+#include "mock_bsp.h"
+
+#define EXPECT_SCHEDULER() BSP_TriggerPendSV_Expect()
+#define EXPECT_BLOCKED() BSP_TriggerPendSV_Expect()
+
+static void idleFn(void *ptr) {}
+
+static uint32_t fired[3];
+
+static void countCallback(void *arg) {
+    fired[(uintptr_t)arg]++;
+}
+
+static void advanceTicks(uint32_t ticks) {
+    for (uint32_t i = 0; i < ticks; i++) {
+        SysTick_Handler();
+        OS_TimerRunExpired();
+    }
+}
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+    OS_TimerServiceInit();
+    fired[0] = fired[1] = fired[2] = 0;
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+void test_ExpiredTimerWakesDaemonOnce(void) {
+    OS_TCBTypeDef *daemon = readyHeadPtr;
+    TEST_ASSERT_EQUAL_STRING("timer daemon", daemon->identifier);
+
+    OS_TimerTypeDef timer0;
+    OS_TimerCreate(&timer0, &countCallback, (void *)0, 3*SYS_TICK_PERIOD_MILLIS, 0);
+    OS_TimerTypeDef timer1;
+    OS_TimerCreate(&timer1, &countCallback, (void *)1, 3*SYS_TICK_PERIOD_MILLIS, 0);
+
+    // Daemon waits for the first expiry
+    runPtr = daemon;
+    EXPECT_BLOCKED();
+    OS_Wait(&osTimerService.semaphore);
+    OS_TimerStart(&timer0);
+    OS_TimerStart(&timer1);
+    runPtr = idlePtr;
+
+    SysTick_Handler();
+    SysTick_Handler();
+    TEST_ASSERT_NOT_NULL(OS_GetBlockedThreadByIdentifier(daemon->identifier));
+
+    // Both timers expire on the same tick, which only causes a single switch to the daemon
+    EXPECT_SCHEDULER();
+    SysTick_Handler();
+    TEST_ASSERT_EQUAL_PTR(daemon, readyHeadPtr);
+    TEST_ASSERT_EQUAL_INT(2, OS_TimerRunExpired());
+    TEST_ASSERT_EQUAL_INT(1, fired[0]);
+    TEST_ASSERT_EQUAL_INT(1, fired[1]);
+}
+
+void test_OneShotTimerFiresOnce(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    OS_TimerTypeDef timer;
+    OS_TimerCreate(&timer, &countCallback, (void *)0, 5*SYS_TICK_PERIOD_MILLIS, 0);
+    OS_TimerStart(&timer);
+
+    advanceTicks(4);
+    TEST_ASSERT_EQUAL_INT(0, fired[0]);
+    advanceTicks(1);
+    TEST_ASSERT_EQUAL_INT(1, fired[0]);
+    TEST_ASSERT_EQUAL_INT(0, timer.active);
+    advanceTicks(20);
+    TEST_ASSERT_EQUAL_INT(1, fired[0]);
+}
+
+void test_AutoReloadTimerKeepsPeriod(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    OS_TimerTypeDef fast;
+    OS_TimerCreate(&fast, &countCallback, (void *)0, 2*SYS_TICK_PERIOD_MILLIS, 1);
+    OS_TimerTypeDef slow;
+    OS_TimerCreate(&slow, &countCallback, (void *)1, 5*SYS_TICK_PERIOD_MILLIS, 1);
+    OS_TimerStart(&slow);
+    OS_TimerStart(&fast);
+    TEST_ASSERT_EQUAL_PTR(&fast, osTimerService.head);
+
+    advanceTicks(20);
+    TEST_ASSERT_EQUAL_INT(10, fired[0]);
+    TEST_ASSERT_EQUAL_INT(4, fired[1]);
+
+    // Daemon did not get to run for 7 ticks, the missed periods are skipped instead of fired back to back
+    for (int i = 0; i < 7; i++) {
+        SysTick_Handler();
+    }
+    TEST_ASSERT_EQUAL_INT(2, OS_TimerRunExpired());
+    TEST_ASSERT_EQUAL_INT(11, fired[0]);
+    TEST_ASSERT_EQUAL_INT(5, fired[1]);
+    TEST_ASSERT_EQUAL_INT(2, osTimerService.overruns);
+    // Next expiry stays on the original grid of the timer
+    TEST_ASSERT_EQUAL_INT(OS_GetSysTickCount() + 1, fast.expiryTick);
+}
+
+void test_StopResetAndChangePeriod(void) {
+    BSP_TriggerPendSV_Ignore();
+
+    OS_TimerTypeDef timer;
+    OS_TimerCreate(&timer, &countCallback, (void *)0, 4*SYS_TICK_PERIOD_MILLIS, 0);
+    OS_TimerStart(&timer);
+    advanceTicks(3);
+    OS_TimerStop(&timer);
+    TEST_ASSERT_NULL(osTimerService.head);
+    advanceTicks(5);
+    TEST_ASSERT_EQUAL_INT(0, fired[0]);
+
+    // Reset restarts the full period from now
+    OS_TimerStart(&timer);
+    advanceTicks(3);
+    OS_TimerReset(&timer);
+    advanceTicks(3);
+    TEST_ASSERT_EQUAL_INT(0, fired[0]);
+    advanceTicks(1);
+    TEST_ASSERT_EQUAL_INT(1, fired[0]);
+
+    OS_TimerChangePeriod(&timer, 1*SYS_TICK_PERIOD_MILLIS);
+    TEST_ASSERT_EQUAL_INT(1, timer.active);
+    advanceTicks(1);
+    TEST_ASSERT_EQUAL_INT(2, fired[0]);
+}
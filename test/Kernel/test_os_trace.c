@@ -0,0 +1,82 @@
+#include "unity.h"
+
+#include "mrtos_config.h"
+#include "os_core.h"
+#include "os_threads.h"
+#include "os_semaphore.h"
+#include "os_scheduling.h"
+#include "os_trace.h"
+#include "mock_bsp.h"
+
+#define EXPECT_SCHEDULER() BSP_TriggerPendSV_Expect()
+#define EXPECT_BLOCKED() BSP_TriggerPendSV_Expect()
+
+static void idleFn(void *ptr) {}
+static void testFn(void *ptr) {}
+
+void setUp(void) {
+    DisableInterrupts_Ignore();
+    BSP_SysClockConfig_Ignore();
+    BSP_HardwareInit_Ignore();
+    OS_CriticalEnter_IgnoreAndReturn(1);
+    OS_CriticalExit_Ignore();
+    BSP_GetActiveInterruptPriority_IgnoreAndReturn(0xFF);
+    BSP_GetTimestamp_IgnoreAndReturn(0);
+
+    static StackElementTypeDef idleStack[20];
+    OS_Init(&idleFn, idleStack, 20);
+    OS_TraceReset();
+}
+
+void tearDown(void) {
+    OS_ResetState();
+}
+
+void test_TraceRecordsSemaphoreEvents(void) {
+    OS_SemaphoreObjectTypeDef flag;
+    OS_InitSemaphore(&flag, SEMAPHORE_FLAG);
+    StackElementTypeDef testStack1[20];
+    runPtr = OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+
+    BSP_GetTimestamp_IgnoreAndReturn(10);
+    EXPECT_BLOCKED();
+    OS_Wait(&flag);
+    BSP_GetTimestamp_IgnoreAndReturn(20);
+    runPtr = idlePtr;
+    EXPECT_SCHEDULER();
+    OS_Signal(&flag);
+
+    TEST_ASSERT_EQUAL_INT(2, osTraceBuffer.writeCount);
+    TEST_ASSERT_EQUAL_INT(TRACE_EVENT_BLOCK, osTraceBuffer.records[0].event);
+    TEST_ASSERT_EQUAL_INT(0, osTraceBuffer.records[0].threadId);
+    TEST_ASSERT_EQUAL_INT(10, osTraceBuffer.records[0].timestamp);
+    TEST_ASSERT_EQUAL_INT((uint32_t)(uintptr_t)&flag, osTraceBuffer.records[0].object);
+    TEST_ASSERT_EQUAL_INT(TRACE_EVENT_SIGNAL, osTraceBuffer.records[1].event);
+    TEST_ASSERT_EQUAL_INT(OS_IDLE_THREAD_ID, osTraceBuffer.records[1].threadId);
+    TEST_ASSERT_EQUAL_INT(20, osTraceBuffer.records[1].timestamp);
+}
+
+void test_TraceRecordsOnlyActualContextSwitches(void) {
+    StackElementTypeDef testStack1[20];
+    OS_TCBTypeDef *thread1 = OS_CreateThread(&testFn, testStack1, 20, 3, "test thread1");
+
+    OS_Schedule();
+    OS_Schedule();
+
+    TEST_ASSERT_EQUAL_INT(1, osTraceBuffer.writeCount);
+    TEST_ASSERT_EQUAL_INT(TRACE_EVENT_SWITCH, osTraceBuffer.records[0].event);
+    TEST_ASSERT_EQUAL_INT(thread1->id, osTraceBuffer.records[0].threadId);
+    TEST_ASSERT_EQUAL_INT((uint32_t)(uintptr_t)idlePtr, osTraceBuffer.records[0].object);
+}
+
+void test_TraceRingKeepsNewestRecords(void) {
+    for (uint32_t i = 0; i < TRACE_BUFFER_RECORDS + 3; i++) {
+        OS_TraceRecord(TRACE_EVENT_USER, 0, i);
+    }
+
+    TEST_ASSERT_EQUAL_INT(TRACE_BUFFER_RECORDS + 3, osTraceBuffer.writeCount);
+    TEST_ASSERT_EQUAL_INT(TRACE_BUFFER_RECORDS, osTraceBuffer.records[0].object);
+    TEST_ASSERT_EQUAL_INT(TRACE_BUFFER_RECORDS + 2, osTraceBuffer.records[2].object);
+    TEST_ASSERT_EQUAL_INT(3, osTraceBuffer.records[3].object);
+    TEST_ASSERT_EQUAL_INT(12, osTraceBuffer.recordSize);
+}
@@ -0,0 +1,70 @@
+//
+// Created by Aleksi on 18/10/2026.
+//
+
+#ifndef SIMPLERTOS_BENCH_TIMER_H
+#define SIMPLERTOS_BENCH_TIMER_H
+
+#include "stdint.h"
+
+/*
+ * Timestamp source for the host benchmarks. Uses the CPU cycle counter where one is available, so results are
+ * reported in cycles, and falls back to clock() ticks everywhere else.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+
+static inline uint64_t benchTimestamp(void) {
+    return __rdtsc();
+}
+#else
+#include <time.h>
+#define BENCH_UNIT "clock ticks"
+
+static inline uint64_t benchTimestamp(void) {
+    return (uint64_t)clock();
+}
+#endif
+
+
+/* ------------------------------------------- Latency distribution ------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Collects every sample so that tail latencies can be reported. On a host the absolute worst case includes
+ * preemption by the host OS, so the 99.9th percentile is printed next to it.
+ */
+typedef struct {
+    uint32_t *samples;
+    uint32_t capacity;
+    uint32_t count;
+    uint64_t total;
+} BenchStatsTypeDef;
+
+static inline void benchRecord(BenchStatsTypeDef *stats, uint64_t elapsed) {
+    if (stats->count < stats->capacity) {
+        stats->samples[stats->count++] = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+        stats->total += elapsed;
+    }
+}
+
+static inline int benchCompare(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static inline void benchReport(const char *name, BenchStatsTypeDef *stats) {
+    if (stats->count == 0) {
+        return;
+    }
+
+    qsort(stats->samples, stats->count, sizeof(uint32_t), benchCompare);
+    printf("%-24s average %8.1f  median %6u  p99.9 %6u  worst %8u %s\n", name, (double)stats->total / stats->count,
+           stats->samples[stats->count / 2], stats->samples[(stats->count * 999ULL) / 1000],
+           stats->samples[stats->count - 1], BENCH_UNIT);
+}
+
+#endif //SIMPLERTOS_BENCH_TIMER_H
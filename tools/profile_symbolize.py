@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""
+Symbolizes a dump of the kernel profiler histogram (osProfilerBuffer, see os_profiler.h) against the ELF file of the
+firmware, and prints a flat profile per thread.
+
+Dump the buffer with the debugger, e.g. in GDB:
+    dump binary memory profile.bin &osProfilerBuffer ((char *)&osProfilerBuffer) + sizeof(osProfilerBuffer)
+
+Usage:
+    profile_symbolize.py profile.bin firmware.elf --nm arm-none-eabi-nm --name 0=sensor --top 20
+"""
+
+import argparse
+import bisect
+import collections
+import struct
+import subprocess
+import sys
+
+PROFILER_MAGIC = 0x464F5250
+HEADER = struct.Struct("<IIIII")
+ENTRY = struct.Struct("<IIB3x")
+IDLE_THREAD_ID = 0xFF
+
+
+def read_histogram(data):
+    magic, entry_size, capacity, samples, dropped = HEADER.unpack_from(data, 0)
+    if magic != PROFILER_MAGIC:
+        sys.exit("not a profiler dump, magic is 0x%08x" % magic)
+    if entry_size != ENTRY.size:
+        sys.exit("entry size %d does not match the script (%d)" % (entry_size, ENTRY.size))
+    if len(data) < HEADER.size + capacity * entry_size:
+        sys.exit("dump is truncated, expected %d entries" % capacity)
+
+    entries = []
+    for i in range(capacity):
+        pc, count, thread_id = ENTRY.unpack_from(data, HEADER.size + i * entry_size)
+        if count:
+            entries.append((pc, thread_id, count))
+    return entries, samples, dropped
+
+
+def read_symbols(elf, nm):
+    """Returns the function symbols of the ELF sorted by address, as (address, size, name)."""
+    output = subprocess.run([nm, "--defined-only", "--print-size", "--numeric-sort", elf],
+                            check=True, capture_output=True, text=True).stdout
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in "tTwW":
+            # Thumb function symbols have the lowest bit set
+            symbols.append((int(fields[0], 16) & ~1, int(fields[1], 16), fields[3]))
+    return symbols
+
+
+def symbolize(pc, symbols, addresses):
+    pc &= ~1
+    index = bisect.bisect_right(addresses, pc) - 1
+    if index >= 0:
+        address, size, name = symbols[index]
+        if pc < address + max(size, 1):
+            return name
+    return "0x%08x" % pc
+
+
+def thread_name(thread_id, names):
+    if thread_id in names:
+        return names[thread_id]
+    return "idle" if thread_id == IDLE_THREAD_ID else "thread %d" % thread_id
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="binary dump of osProfilerBuffer")
+    parser.add_argument("elf", help="ELF file of the firmware the dump was taken from")
+    parser.add_argument("--nm", default="arm-none-eabi-nm", help="nm executable that understands the ELF")
+    parser.add_argument("--name", action="append", default=[], metavar="ID=NAME", help="name for a thread id")
+    parser.add_argument("--top", type=int, default=15, help="functions to print per thread")
+    args = parser.parse_args()
+
+    names = {}
+    for entry in args.name:
+        thread_id, name = entry.split("=", 1)
+        names[int(thread_id, 0)] = name
+
+    with open(args.dump, "rb") as dump:
+        entries, samples, dropped = read_histogram(dump.read())
+
+    symbols = read_symbols(args.elf, args.nm)
+    addresses = [symbol[0] for symbol in symbols]
+
+    profiles = collections.defaultdict(collections.Counter)
+    for pc, thread_id, count in entries:
+        profiles[thread_id][symbolize(pc, symbols, addresses)] += count
+
+    print("%d samples, %d dropped because the histogram was full" % (samples, dropped))
+    for thread_id, profile in sorted(profiles.items(), key=lambda item: -sum(item[1].values())):
+        thread_samples = sum(profile.values())
+        print("\n%s: %d samples (%.1f%%)" % (thread_name(thread_id, names), thread_samples,
+                                            100.0 * thread_samples / max(samples, 1)))
+        for function, count in profile.most_common(args.top):
+            print("  %6.1f%%  %8d  %s" % (100.0 * count / thread_samples, count, function))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""
+Generates a static schedule table for the time triggered dispatch of os_table.h from periodic task declarations.
+
+Every task is released at a fixed phase within its period, and the phases are chosen so that no two jobs overlap
+within the hyperperiod, assuming each job finishes within its worst case execution time. Tasks are placed from the
+shortest period up, each at the first phase where all of its jobs fit.
+
+The task file has one task per line, times in milliseconds, # starts a comment:
+    # name      period  wcet
+    control     10      2
+    telemetry   20      3
+    logger      40      1
+
+Usage:
+    schedule_table_gen.py tasks.txt --tick-ms 1 -o schedule_table.h
+
+The output header names the tasks TABLE_TASK_<NAME>, the application creates a thread for each of them with
+OS_CreateTableThread, stores them in an array indexed by those names and passes it to OS_TableInit along with
+scheduleTableEntries, SCHEDULE_TABLE_LENGTH and SCHEDULE_TABLE_HYPERPERIOD.
+"""
+
+import argparse
+import math
+import os
+import re
+import sys
+
+
+def read_tasks(path, tick_ms):
+    """Returns the tasks as (name, period, wcet) with times converted to SysTicks."""
+    tasks = []
+    with open(path) as task_file:
+        for line_number, line in enumerate(task_file, 1):
+            fields = line.split("#", 1)[0].split()
+            if not fields:
+                continue
+            if len(fields) != 3:
+                sys.exit("%s:%d: expected name, period and wcet" % (path, line_number))
+
+            name, period_ms, wcet_ms = fields[0], float(fields[1]), float(fields[2])
+            if not re.match(r"^[A-Za-z_]\w*$", name):
+                sys.exit("%s:%d: task name %r is not a C identifier" % (path, line_number, name))
+            period = period_ms / tick_ms
+            if period != int(period) or period < 1:
+                sys.exit("%s:%d: period of %s is not a whole number of %g ms ticks" % (path, line_number, name,
+                                                                                       tick_ms))
+            # A job that needs any part of a tick takes the whole tick
+            wcet = max(1, math.ceil(wcet_ms / tick_ms))
+            if wcet > period:
+                sys.exit("%s:%d: wcet of %s is longer than its period" % (path, line_number, name))
+            tasks.append((name, int(period), wcet))
+
+    if not tasks:
+        sys.exit("%s: no tasks" % path)
+    return tasks
+
+
+def hyperperiod_of(tasks):
+    hyperperiod = 1
+    for _, period, _ in tasks:
+        hyperperiod = hyperperiod * period // math.gcd(hyperperiod, period)
+    return hyperperiod
+
+
+def build_table(tasks, hyperperiod):
+    """Returns the table entries as (offset, task index) ordered by offset, exits if the tasks do not fit."""
+    busy = [False] * hyperperiod
+    entries = []
+
+    # Shortest periods have the fewest phases to choose from, so they are placed first
+    order = sorted(range(len(tasks)), key=lambda index: tasks[index][1])
+    for index in order:
+        name, period, wcet = tasks[index]
+        releases = range(0, hyperperiod, period)
+        for phase in range(period):
+            ticks = [(release + phase + i) % hyperperiod for release in releases for i in range(wcet)]
+            if not any(busy[tick] for tick in ticks):
+                break
+        else:
+            sys.exit("no phase fits %s, the table is full at %d of %d ticks" % (name, sum(busy), hyperperiod))
+
+        for tick in ticks:
+            busy[tick] = True
+        entries.extend((release + phase, index) for release in releases)
+
+    return sorted(entries), sum(busy)
+
+
+def write_header(output, header_name, source, tasks, hyperperiod, entries):
+    guard = re.sub(r"\W", "_", os.path.basename(header_name)).upper()
+    task_names = ["TABLE_TASK_%s" % name.upper() for name, _, _ in tasks]
+
+    output.write("// Generated by tools/schedule_table_gen.py from %s, do not edit\n\n" % os.path.basename(source))
+    output.write("#ifndef %s\n#define %s\n\n#include \"os_table.h\"\n\n" % (guard, guard))
+    output.write("enum {\n")
+    for task_name, (_, period, wcet) in zip(task_names, tasks):
+        output.write("    %s,  // period %d, wcet %d ticks\n" % (task_name, period, wcet))
+    output.write("    TABLE_TASK_COUNT\n};\n\n")
+    output.write("#define SCHEDULE_TABLE_HYPERPERIOD %d\n" % hyperperiod)
+    output.write("#define SCHEDULE_TABLE_LENGTH %d\n\n" % len(entries))
+    output.write("static const OS_TableEntryTypeDef scheduleTableEntries[SCHEDULE_TABLE_LENGTH] = {\n")
+    for offset, index in entries:
+        output.write("    {%d, %s},\n" % (offset, task_names[index]))
+    output.write("};\n\n#endif //%s\n" % guard)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("tasks", help="task declaration file")
+    parser.add_argument("-o", "--output", help="output header, stdout by default")
+    parser.add_argument("--tick-ms", type=float, default=1.0, help="SYS_TICK_PERIOD_MILLIS of the target")
+    parser.add_argument("--max-hyperperiod", type=int, default=100000, help="largest table accepted, in ticks")
+    args = parser.parse_args()
+
+    tasks = read_tasks(args.tasks, args.tick_ms)
+    hyperperiod = hyperperiod_of(tasks)
+    if hyperperiod > args.max_hyperperiod:
+        sys.exit("hyperperiod of %d ticks is over the limit, make the periods harmonic" % hyperperiod)
+
+    entries, busy = build_table(tasks, hyperperiod)
+    print("%d entries over %d ticks, %.1f%% of the ticks taken by the table"
+          % (len(entries), hyperperiod, 100.0 * busy / hyperperiod), file=sys.stderr)
+
+    if args.output:
+        with open(args.output, "w") as output:
+            write_header(output, args.output, args.tasks, tasks, hyperperiod, entries)
+    else:
+        write_header(sys.stdout, "schedule_table.h", args.tasks, tasks, hyperperiod, entries)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+Converts a dump of the kernel trace ring (osTraceBuffer, see os_trace.h) into Chrome trace event JSON, which can be
+opened in chrome://tracing or https://ui.perfetto.dev.
+
+Dump the buffer with the debugger, e.g. in GDB:
+    dump binary memory trace.bin &osTraceBuffer ((char *)&osTraceBuffer) + sizeof(osTraceBuffer)
+
+Usage:
+    trace_decode.py trace.bin --clock-mhz 80 --name 0=sensor --name 1=logger -o trace.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x45435254
+HEADER = struct.Struct("<IIII")
+RECORD = struct.Struct("<IIBBH")
+IDLE_THREAD_ID = 0xFF
+
+EVENT_SWITCH = 1
+EVENT_NAMES = {
+    1: "switch",
+    2: "systick",
+    3: "wake",
+    4: "wait",
+    5: "block",
+    6: "signal",
+    7: "user",
+}
+
+
+def read_records(data):
+    """Returns the records in the ring from the oldest to the newest."""
+    magic, record_size, capacity, write_count = HEADER.unpack_from(data, 0)
+    if magic != TRACE_MAGIC:
+        sys.exit("not a trace dump, magic is 0x%08x" % magic)
+    if record_size != RECORD.size:
+        sys.exit("record size %d does not match the decoder (%d)" % (record_size, RECORD.size))
+
+    available = min(write_count, capacity)
+    if len(data) < HEADER.size + capacity * record_size:
+        sys.exit("dump is truncated, expected %d records" % capacity)
+
+    records = []
+    for i in range(write_count - available, write_count):
+        offset = HEADER.size + (i % capacity) * record_size
+        timestamp, obj, event, thread_id, _ = RECORD.unpack_from(data, offset)
+        records.append((timestamp, obj, event, thread_id))
+
+    if write_count > capacity:
+        print("ring has wrapped, %d oldest records were lost" % (write_count - capacity), file=sys.stderr)
+    return records
+
+
+def unwrap_timestamps(records):
+    """The 32-bit timestamp rolls over, make it monotonic so the timeline stays in order."""
+    unwrapped = []
+    base = 0
+    previous = None
+    for timestamp, obj, event, thread_id in records:
+        if previous is not None and timestamp < previous:
+            base += 1 << 32
+        previous = timestamp
+        unwrapped.append((base + timestamp, obj, event, thread_id))
+    return unwrapped
+
+
+def thread_name(thread_id, names):
+    if thread_id in names:
+        return names[thread_id]
+    return "idle" if thread_id == IDLE_THREAD_ID else "thread %d" % thread_id
+
+
+def to_chrome_events(records, clock_mhz, names):
+    events = []
+    seen_threads = set()
+    running = None
+    slice_start = 0.0
+
+    for ticks, obj, event, thread_id in records:
+        us = ticks / clock_mhz
+        seen_threads.add(thread_id)
+
+        if event == EVENT_SWITCH:
+            # Each thread gets a row, and a slice for every period it was running
+            if running is not None:
+                events.append({"name": thread_name(running, names), "ph": "X", "pid": 0, "tid": running,
+                               "ts": slice_start, "dur": us - slice_start})
+            running = thread_id
+            slice_start = us
+        else:
+            events.append({"name": EVENT_NAMES.get(event, "event %d" % event), "ph": "i", "s": "t", "pid": 0,
+                           "tid": thread_id, "ts": us, "args": {"object": "0x%08x" % obj}})
+
+    if running is not None and records:
+        end = records[-1][0] / clock_mhz
+        events.append({"name": thread_name(running, names), "ph": "X", "pid": 0, "tid": running,
+                       "ts": slice_start, "dur": end - slice_start})
+
+    for thread_id in sorted(seen_threads):
+        events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": thread_id,
+                       "args": {"name": thread_name(thread_id, names)}})
+    return events
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="binary dump of osTraceBuffer")
+    parser.add_argument("-o", "--output", help="output JSON file, stdout by default")
+    parser.add_argument("--clock-mhz", type=float, default=80.0, help="BSP_GetTimestamp frequency in MHz")
+    parser.add_argument("--name", action="append", default=[], metavar="ID=NAME", help="name for a thread id")
+    args = parser.parse_args()
+
+    names = {}
+    for entry in args.name:
+        thread_id, name = entry.split("=", 1)
+        names[int(thread_id, 0)] = name
+
+    with open(args.dump, "rb") as dump:
+        data = dump.read()
+
+    records = unwrap_timestamps(read_records(data))
+    trace = {"traceEvents": to_chrome_events(records, args.clock_mhz, names), "displayTimeUnit": "ns"}
+
+    if args.output:
+        with open(args.output, "w") as output:
+            json.dump(trace, output, indent=1)
+    else:
+        json.dump(trace, sys.stdout, indent=1)
+
+
+if __name__ == "__main__":
+    main()